@@ -2,13 +2,67 @@
 
 #include "byte_stream.hh"
 #include "eventloop.hh"
+#include "exception.hh"
 
 #include <algorithm>
+#include <array>
+#include <fcntl.h>
 #include <iostream>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
 #include <unistd.h>
 
 using namespace std;
 
+namespace {
+
+// A kernel pipe that relays one direction with splice(2), so its bytes never enter user space.
+struct SplicePipe
+{
+  FileDescriptor read_end;
+  FileDescriptor write_end;
+  size_t capacity;
+  // The kernel sizes a pipe in page slots, and a short splice fills a whole slot, so the pipe can refuse
+  // bytes while the stream still shows capacity. Set when that happens; cleared once the pipe drains.
+  bool full = false;
+};
+
+SplicePipe make_splice_pipe( const size_t size )
+{
+  array<int, 2> fds {};
+  CheckSystemCall( "pipe2", pipe2( fds.data(), O_NONBLOCK | O_CLOEXEC ) );
+  FileDescriptor read_end { fds[0] };
+  FileDescriptor write_end { fds[1] };
+
+  // ask for a pipe as large as the buffered path's stream, but keep whatever size the kernel grants
+  fcntl( write_end.fd_num(), F_SETPIPE_SZ, static_cast<int>( size ) ); // NOLINT(*-vararg)
+  const int capacity = CheckSystemCall( "fcntl", fcntl( write_end.fd_num(), F_GETPIPE_SZ ) ); // NOLINT(*-vararg)
+
+  return { move( read_end ), move( write_end ), static_cast<size_t>( capacity ), false };
+}
+
+// Relay through a pipe when both ends support splice(2); otherwise (e.g. a terminal) copy through a buffer.
+optional<SplicePipe> relay_pipe( const FileDescriptor& source, const FileDescriptor& sink, const size_t size )
+{
+  if ( source.can_splice() and sink.can_splice() ) {
+    return make_splice_pipe( size );
+  }
+  return nullopt;
+}
+
+// In splice mode the stream only counts the bytes sitting in the pipe.
+ByteStream relay_stream( const optional<SplicePipe>& pipe, const size_t size )
+{
+  if ( pipe ) {
+    return ByteStream { pipe->capacity, ByteStream::Storage::External };
+  }
+  return ByteStream { size, ByteStream::Storage::Mirrored };
+}
+
+} // namespace
+
 void bidirectional_stream_copy( Socket& socket, string_view peer_name )
 {
   constexpr size_t buffer_size = 1048576;
@@ -16,10 +70,14 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
   EventLoop _eventloop {};
   FileDescriptor _input { STDIN_FILENO };
   FileDescriptor _output { STDOUT_FILENO };
-  ByteStream _outbound { buffer_size };
-  ByteStream _inbound { buffer_size };
+  optional<SplicePipe> _outbound_pipe = relay_pipe( _input, socket, buffer_size );
+  optional<SplicePipe> _inbound_pipe = relay_pipe( socket, _output, buffer_size );
+  ByteStream _outbound = relay_stream( _outbound_pipe, buffer_size );
+  ByteStream _inbound = relay_stream( _inbound_pipe, buffer_size );
   bool _outbound_shutdown { false };
   bool _inbound_shutdown { false };
+  vector<string_view> _pending {};
+  vector<span<char>> _free {};
 
   socket.set_blocking( false );
   _input.set_blocking( false );
@@ -31,17 +89,22 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     _input,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _outbound.writer().available_capacity() );
-      _input.read( data );
-      _outbound.writer().push( move( data ) );
+      _outbound.writer().reserve( _outbound.writer().available_capacity(), _free );
+      if ( _outbound_pipe ) {
+        const size_t moved
+          = _outbound_pipe->write_end.splice_from( _input, _outbound.writer().available_capacity() );
+        _outbound_pipe->full = moved == 0 and not _input.eof() and _outbound.reader().bytes_buffered() > 0;
+        _outbound.writer().commit( moved );
+      } else {
+        _outbound.writer().commit( _input.read_into( _free ) );
+      }
       if ( _input.eof() ) {
         _outbound.writer().close();
       }
     },
     [&] {
       return !_outbound.has_error() and !_inbound.has_error() and ( _outbound.writer().available_capacity() > 0 )
-             and !_outbound.writer().is_closed();
+             and !_outbound.writer().is_closed() and !( _outbound_pipe and _outbound_pipe->full );
     },
     [&] { _outbound.writer().close(); },
     [&] {
@@ -56,8 +119,13 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::Out,
     [&] {
-      if ( _outbound.reader().bytes_buffered() ) {
-        _outbound.reader().pop( socket.write( _outbound.reader().peek() ) );
+      if ( _outbound.reader().bytes_buffered() and _outbound_pipe ) {
+        _outbound.reader().pop(
+          socket.splice_from( _outbound_pipe->read_end, _outbound.reader().bytes_buffered() ) );
+        _outbound_pipe->full = false;
+      } else if ( _outbound.reader().bytes_buffered() ) {
+        _outbound.reader().peek_all( _pending );
+        _outbound.reader().pop( socket.write( _pending ) );
       }
       if ( _outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
@@ -81,17 +149,21 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _inbound.writer().available_capacity() );
-      socket.read( data );
-      _inbound.writer().push( move( data ) );
+      _inbound.writer().reserve( _inbound.writer().available_capacity(), _free );
+      if ( _inbound_pipe ) {
+        const size_t moved = _inbound_pipe->write_end.splice_from( socket, _inbound.writer().available_capacity() );
+        _inbound_pipe->full = moved == 0 and not socket.eof() and _inbound.reader().bytes_buffered() > 0;
+        _inbound.writer().commit( moved );
+      } else {
+        _inbound.writer().commit( socket.read_into( _free ) );
+      }
       if ( socket.eof() ) {
         _inbound.writer().close();
       }
     },
     [&] {
       return !_inbound.has_error() and !_outbound.has_error() and ( _inbound.writer().available_capacity() > 0 )
-             and !_inbound.writer().is_closed();
+             and !_inbound.writer().is_closed() and !( _inbound_pipe and _inbound_pipe->full );
     },
     [&] { _inbound.writer().close(); },
     [&] {
@@ -106,8 +178,12 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     _output,
     Direction::Out,
     [&] {
-      if ( _inbound.reader().bytes_buffered() ) {
-        _inbound.reader().pop( _output.write( _inbound.reader().peek() ) );
+      if ( _inbound.reader().bytes_buffered() and _inbound_pipe ) {
+        _inbound.reader().pop( _output.splice_from( _inbound_pipe->read_end, _inbound.reader().bytes_buffered() ) );
+        _inbound_pipe->full = false;
+      } else if ( _inbound.reader().bytes_buffered() ) {
+        _inbound.reader().peek_all( _pending );
+        _inbound.reader().pop( _output.write( _pending ) );
       }
       if ( _inbound.reader().is_finished() ) {
         _output.close();
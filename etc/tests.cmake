@@ -23,6 +23,18 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_chunked)
+ttest(byte_stream_peek_all)
+ttest(byte_stream_reserve)
+ttest(byte_stream_spsc)
+ttest(byte_stream_mirrored)
+ttest(byte_stream_paged)
+ttest(byte_stream_read_into)
+ttest(byte_stream_static)
+ttest(byte_stream_broadcast)
+ttest(byte_stream_resize)
+ttest(slab_allocator)
+ttest(presence_bitmap)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -31,12 +43,19 @@ ttest(reassembler_dup)
 ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
+ttest(reassembler_bitmap)
+ttest(reassembler_slices)
+ttest(reassembler_flood)
+ttest(reassembler_sack)
+ttest(reassembler_batch)
+ttest(reassembler_shared)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
 ttest(wrapping_integers_unwrap)
 ttest(wrapping_integers_roundtrip)
 ttest(wrapping_integers_extra)
+ttest(wrapping_integers_constexpr)
 
 ttest(recv_connect)
 ttest(recv_transmit)
@@ -45,6 +64,10 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_fast_path)
+ttest(recv_delayed_ack)
+ttest(recv_window_scale)
+ttest(recv_autotune)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -89,4 +112,12 @@ set_property(TEST ${compile_name_opt} PROPERTY TIMEOUT 0)
 set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
+stest(byte_stream_spsc_speed_test)
+stest(byte_stream_static_speed_test)
+stest(slab_allocator_speed_test)
+stest(presence_bitmap_speed_test)
 stest(reassembler_speed_test)
+stest(reassembler_batch_speed_test)
+stest(reassembler_patterns_speed_test)
+stest(recv_speed_test)
+stest(wrapping_integers_speed_test)
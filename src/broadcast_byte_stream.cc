@@ -0,0 +1,150 @@
+#include "broadcast_byte_stream.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+BroadcastByteStream::BroadcastByteStream( uint64_t capacity, size_t num_readers )
+  : buffer_( capacity ), capacity_( capacity )
+{
+  if ( num_readers == 0 ) {
+    throw invalid_argument( "BroadcastByteStream needs at least one reader" );
+  }
+  readers_.reserve( num_readers );
+  for ( size_t i = 0; i < num_readers; ++i ) {
+    readers_.emplace_back( *this );
+  }
+}
+
+void BroadcastByteStream::reclaim()
+{
+  slowest_read_ = bytes_written_;
+  for ( const auto& r : readers_ ) {
+    slowest_read_ = min( slowest_read_, r.bytes_popped() );
+  }
+}
+
+void BroadcastByteStream::Writer::push( string data )
+{
+  if ( closed_ || error_ ) {
+    set_error();
+    return;
+  }
+
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), available_capacity() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  // 与 ByteStream 的 Ring 模式相同，最多两次 memcpy；所有读端看到的都是这一份拷贝
+  const uint64_t pos = bytes_written_ % capacity_;
+  const uint64_t first = min( len, capacity_ - pos );
+  memcpy( buffer_.data() + pos, data.data(), first );
+  memcpy( buffer_.data(), data.data() + first, len - first );
+  bytes_written_ += len;
+}
+
+void BroadcastByteStream::Writer::close()
+{
+  closed_ = true;
+}
+
+bool BroadcastByteStream::Writer::is_closed() const
+{
+  return closed_;
+}
+
+uint64_t BroadcastByteStream::Writer::available_capacity() const
+{
+  return capacity_ - ( bytes_written_ - slowest_read_ );
+}
+
+uint64_t BroadcastByteStream::Writer::bytes_pushed() const
+{
+  return bytes_written_;
+}
+
+string_view BroadcastByteStream::Reader::peek() const
+{
+  if ( bytes_buffered() == 0 ) {
+    return {};
+  }
+  const uint64_t pos = bytes_read_ % stream_->capacity_;
+  return { stream_->buffer_.data() + pos, min( bytes_buffered(), stream_->capacity_ - pos ) };
+}
+
+void BroadcastByteStream::Reader::peek_all( vector<string_view>& views ) const
+{
+  views.clear();
+  const string_view first = peek();
+  if ( first.empty() ) {
+    return;
+  }
+  views.push_back( first );
+  if ( first.size() < bytes_buffered() ) {
+    views.emplace_back( stream_->buffer_.data(), bytes_buffered() - first.size() );
+  }
+}
+
+void BroadcastByteStream::Reader::pop( uint64_t len )
+{
+  len = min( len, bytes_buffered() );
+  const bool was_slowest = bytes_read_ == stream_->slowest_read_;
+  bytes_read_ += len;
+  // 其他读端更慢时，空间仍然被它们占着，不需要重新扫描
+  if ( was_slowest && len > 0 ) {
+    stream_->reclaim();
+  }
+}
+
+uint64_t BroadcastByteStream::Reader::read_into( span<char> out )
+{
+  const uint64_t len = min( static_cast<uint64_t>( out.size() ), bytes_buffered() );
+  if ( len == 0 ) {
+    return 0;
+  }
+  const uint64_t pos = bytes_read_ % stream_->capacity_;
+  const uint64_t first = min( len, stream_->capacity_ - pos );
+  memcpy( out.data(), stream_->buffer_.data() + pos, first );
+  memcpy( out.data() + first, stream_->buffer_.data(), len - first );
+  pop( len );
+  return len;
+}
+
+bool BroadcastByteStream::Reader::is_finished() const
+{
+  return stream_->closed_ && bytes_buffered() == 0;
+}
+
+uint64_t BroadcastByteStream::Reader::bytes_buffered() const
+{
+  return stream_->bytes_written_ - bytes_read_;
+}
+
+BroadcastByteStream::Reader& BroadcastByteStream::reader( size_t index )
+{
+  return readers_.at( index );
+}
+
+const BroadcastByteStream::Reader& BroadcastByteStream::reader( size_t index ) const
+{
+  return readers_.at( index );
+}
+
+BroadcastByteStream::Writer& BroadcastByteStream::writer()
+{
+  static_assert( sizeof( Writer ) == sizeof( BroadcastByteStream ),
+                 "Please add member variables to the BroadcastByteStream base, not its Writer." );
+
+  return static_cast<Writer&>( *this ); // NOLINT(*-downcast)
+}
+
+const BroadcastByteStream::Writer& BroadcastByteStream::writer() const
+{
+  static_assert( sizeof( Writer ) == sizeof( BroadcastByteStream ),
+                 "Please add member variables to the BroadcastByteStream base, not its Writer." );
+
+  return static_cast<const Writer&>( *this ); // NOLINT(*-downcast)
+}
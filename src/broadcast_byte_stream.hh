@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * BroadcastByteStream: 一个写端、多个读端共享同一块缓冲区的 ByteStream。
+ *
+ * 每个读端有自己的读计数，互不影响地 peek/pop；字节只写入一次，不再为每个消费者各复制一份流。
+ * 缓冲区中的一个字节要等所有读端都 pop 之后才能被覆盖，所以写端的 available_capacity()
+ * 由最慢的读端决定。存储是定长环形缓冲区，与 ByteStream 的 Ring 模式一致。
+ */
+class BroadcastByteStream
+{
+public:
+  class Reader;
+  class Writer;
+
+  BroadcastByteStream( uint64_t capacity, size_t num_readers );
+
+  // 第 `index` 个读端
+  Reader& reader( size_t index );
+  const Reader& reader( size_t index ) const;
+  size_t num_readers() const { return readers_.size(); }
+  Writer& writer();
+  const Writer& writer() const;
+
+  void set_error() { error_ = true; }
+  bool has_error() const { return error_; }
+
+  // 读端保存着指向流的指针，流不能被复制或移动
+  BroadcastByteStream( const BroadcastByteStream& other ) = delete;
+  BroadcastByteStream& operator=( const BroadcastByteStream& other ) = delete;
+  BroadcastByteStream( BroadcastByteStream&& other ) = delete;
+  BroadcastByteStream& operator=( BroadcastByteStream&& other ) = delete;
+  ~BroadcastByteStream() = default;
+
+protected:
+  std::vector<char> buffer_;
+  uint64_t capacity_;
+  bool error_ {};
+  bool closed_ {};
+  uint64_t bytes_written_ {};
+  // 最慢的读端已经弹出的字节数：[slowest_read_, bytes_written_) 之外的空间都可以写
+  uint64_t slowest_read_ {};
+  std::vector<Reader> readers_ {};
+
+  // 有读端弹出后重新计算 slowest_read_
+  void reclaim();
+};
+
+class BroadcastByteStream::Writer : public BroadcastByteStream
+{
+public:
+  void push( std::string data );
+  void close();
+
+  bool is_closed() const;
+  // 以最慢的读端为准还能写多少字节
+  uint64_t available_capacity() const;
+  uint64_t bytes_pushed() const;
+};
+
+class BroadcastByteStream::Reader
+{
+public:
+  explicit Reader( BroadcastByteStream& stream ) : stream_( &stream ) {}
+
+  std::string_view peek() const;
+  // 按顺序放入本读端所有连续可读区域（至多两段）
+  void peek_all( std::vector<std::string_view>& views ) const;
+  // 只移动本读端的读计数；它原本是最慢的读端时，空出来的空间才还给写端
+  void pop( uint64_t len );
+  uint64_t read_into( std::span<char> out );
+
+  bool is_finished() const;
+  uint64_t bytes_buffered() const;
+  uint64_t bytes_popped() const { return bytes_read_; }
+
+private:
+  BroadcastByteStream* stream_;
+  uint64_t bytes_read_ {};
+};
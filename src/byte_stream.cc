@@ -1,8 +1,52 @@
 #include "byte_stream.hh"
 
+#include <cstring>
+
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ) {}
+ByteStream::ByteStream( uint64_t capacity, Storage storage ) : capacity_( capacity ), storage_( storage )
+{
+  if ( storage_ == Storage::Mirrored && !MirroredBuffer::supported( capacity_ ) ) {
+    storage_ = Storage::Ring;
+  }
+
+  if ( storage_ == Storage::Ring ) {
+    buffer_.resize( capacity_ );
+  } else if ( storage_ == Storage::Mirrored ) {
+    mirror_ = MirroredBuffer { capacity_ };
+  }
+}
+
+uint64_t ByteStream::memory_usage() const
+{
+  switch ( storage_ ) {
+    case Storage::Ring:
+      return buffer_.capacity();
+    case Storage::Mirrored:
+      return mirror_.size();
+    case Storage::Chunked: {
+      uint64_t total = reserved_chunk_.capacity();
+      for ( const auto& chunk : chunks_ ) {
+        total += chunk.storage_capacity();
+      }
+      return total;
+    }
+    case Storage::Paged:
+      return pages_.size() * PagePool::kPageSize;
+    case Storage::External:
+      return 0;
+  }
+  return 0;
+}
+
+char* ByteStream::page_slot( uint64_t index )
+{
+  const uint64_t page = ( index - page_base() ) / PagePool::kPageSize;
+  while ( pages_.size() <= page ) {
+    pages_.emplace_back();
+  }
+  return pages_[page].data() + index % PagePool::kPageSize;
+}
 
 bool Writer::is_closed() const
 {
@@ -11,22 +55,137 @@ bool Writer::is_closed() const
 }
 
 void Writer::push( string data )
+{
+  if ( storage_ == Storage::Chunked ) {
+    // 把 string 移进共享存储，不拷贝字节
+    push( BufferSlice { move( data ) } );
+    return;
+  }
+  push_bytes( data );
+}
+
+void Writer::push( BufferSlice data )
+{
+  if ( storage_ != Storage::Chunked ) {
+    push_bytes( data.view() );
+    return;
+  }
+
+  if ( closed_ || error_ ) {
+    set_error();
+    return;
+  }
+  // 超出可用容量的部分直接丢弃：截断只缩短切片的长度，然后把整个切片存下来
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), available_capacity() );
+  if ( len == 0 ) {
+    return;
+  }
+  data.truncate( len );
+  chunks_.push_back( move( data ) );
+  bytes_written_ += len;
+}
+
+void Writer::push_bytes( string_view data )
 {
   // 如果流已经关闭或者是有错误发生，那么就设置error为true，然后退出程序
+  // External 模式没有地方存放数据，push 同样视为错误
+  if ( closed_ || error_ || storage_ == Storage::External ) {
+    set_error();
+    return;
+  }
+
+  // 超出可用容量的部分直接丢弃，只写入前 len 个字节
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), available_capacity() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  if ( storage_ == Storage::Paged ) {
+    // 逐页拷贝，写到页尾时由 page_slot 补一页新的
+    for ( uint64_t copied = 0; copied < len; ) {
+      const uint64_t index = bytes_written_ + copied;
+      const uint64_t n = min( len - copied, PagePool::kPageSize - index % PagePool::kPageSize );
+      memcpy( page_slot( index ), data.data() + copied, n );
+      copied += n;
+    }
+    bytes_written_ += len;
+    return;
+  }
+
+  // 写位置到缓冲区末尾的部分先拷贝，剩下的回绕到缓冲区开头，最多两次 memcpy（Mirrored 模式一次拷完）
+  const uint64_t pos = write_pos();
+  const uint64_t first = min( len, contiguous( pos ) );
+  memcpy( ring() + pos, data.data(), first );
+  memcpy( ring(), data.data() + first, len - first );
+  // 写入完成后，把写入的字节数加上实际写入的大小
+  bytes_written_ += len;
+}
+
+void Writer::reserve( uint64_t len, vector<span<char>>& spans )
+{
+  spans.clear();
+  len = min( len, available_capacity() );
+  reserved_ = ( closed_ || error_ ) ? 0 : len;
+  if ( reserved_ == 0 ) {
+    return;
+  }
+
+  if ( storage_ == Storage::External ) {
+    // 只记下预留的长度，数据由调用者在流外搬运
+    return;
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    reserved_chunk_.resize( len );
+    spans.emplace_back( reserved_chunk_.data(), len );
+    return;
+  }
+
+  if ( storage_ == Storage::Paged ) {
+    // 每页一段，预留时就把页分配好；commit 时归还没用上的页
+    for ( uint64_t offset = 0; offset < len; ) {
+      const uint64_t index = bytes_written_ + offset;
+      const uint64_t n = min( len - offset, PagePool::kPageSize - index % PagePool::kPageSize );
+      spans.emplace_back( page_slot( index ), n );
+      offset += n;
+    }
+    return;
+  }
+
+  // 与 push 相同：写位置到缓冲区末尾，以及回绕到缓冲区开头的部分
+  const uint64_t pos = write_pos();
+  const uint64_t first = min( len, contiguous( pos ) );
+  spans.emplace_back( ring() + pos, first );
+  if ( first < len ) {
+    spans.emplace_back( ring(), len - first );
+  }
+}
+
+void Writer::commit( uint64_t len )
+{
   if ( closed_ || error_ ) {
     set_error();
     return;
   }
 
-  if ( data.length() > available_capacity() ) { // 如果插入数据长度大于可用的容量，那么就截断数据
-    data = data.substr( 0, available_capacity() ); // 截断数据以适应可用容量，并修改data为截断后的数据
+  len = min( len, reserved_ );
+  reserved_ = 0;
+
+  if ( storage_ == Storage::Chunked && len > 0 ) {
+    reserved_chunk_.resize( len );
+    chunks_.emplace_back( move( reserved_chunk_ ) );
+    reserved_chunk_ = string {};
+  }
+  bytes_written_ += len;
+
+  if ( storage_ == Storage::Paged ) {
+    // 只保留覆盖到写位置为止的页
+    const uint64_t end = bytes_written_ == bytes_read_ ? page_base() : bytes_written_;
+    const uint64_t needed = ( end - page_base() + PagePool::kPageSize - 1 ) / PagePool::kPageSize;
+    while ( pages_.size() > needed ) {
+      pages_.pop_back();
+    }
   }
-  // 在双端队列中插入数据，使用copy函数可实现拷贝string中的数据到双端队列buffer_中
-  // std::back_inserter 是一个插入迭代器，它提供一种通用的方式来将元素插入到容器的末尾。在这个场景下，每当 std::copy
-  // 算法尝试通过迭代器写入一个元素时， std::back_inserter 调用双端队列的 push_back 方法，将新元素添加到队列的末尾。
-  std::copy( data.begin(), data.end(), std::back_inserter( buffer_ ) );
-  // 写入完成后，把写入的字节数加上data的大小
-  bytes_written_ += data.size();
 }
 
 void Writer::close()
@@ -35,12 +194,48 @@ void Writer::close()
   // Your code here.
 }
 
-uint64_t Writer::available_capacity() const
+void Writer::set_capacity( uint64_t capacity )
 {
+  // 已缓冲的字节不能丢
+  capacity = max( capacity, bytes_written_ - bytes_read_ );
+  reserved_ = 0;
+  reserved_chunk_.clear();
+  if ( storage_ != Storage::Ring && storage_ != Storage::Mirrored ) {
+    // Chunked、Paged 和 External 模式占用的内存只和缓冲的字节数有关
+    capacity_ = capacity;
+    return;
+  }
+
+  // 环形缓冲区的读写位置对容量取模：先按顺序把缓冲的字节拷出来，换好缓冲区后放到新的读位置
+  vector<string_view> views;
+  reader().peek_all( views );
+  string buffered;
+  buffered.reserve( bytes_written_ - bytes_read_ );
+  for ( const auto view : views ) {
+    buffered.append( view );
+  }
+
+  capacity_ = capacity;
+  if ( storage_ == Storage::Mirrored && MirroredBuffer::supported( capacity_ ) ) {
+    mirror_ = MirroredBuffer { capacity_ };
+  } else {
+    storage_ = Storage::Ring;
+    mirror_ = MirroredBuffer {};
+    decltype( buffer_ ) fresh( capacity_ );
+    buffer_.swap( fresh );
+  }
+  if ( !buffered.empty() ) {
+    const uint64_t pos = read_pos();
+    const uint64_t first = min<uint64_t>( buffered.size(), contiguous( pos ) );
+    memcpy( ring() + pos, buffered.data(), first );
+    memcpy( ring(), buffered.data() + first, buffered.size() - first );
+  }
+}
 
+uint64_t Writer::available_capacity() const
+{
   // Your code here.
-  uint64_t ava_capacity = capacity_ - buffer_.size();
-  return ava_capacity;
+  return capacity_ - ( bytes_written_ - bytes_read_ );
 }
 
 uint64_t Writer::bytes_pushed() const
@@ -52,8 +247,7 @@ uint64_t Writer::bytes_pushed() const
 bool Reader::is_finished() const
 {
   // Your code here.
-  bool res = closed_ && buffer_.empty();
-  return res;
+  return closed_ && bytes_buffered() == 0;
 }
 
 uint64_t Reader::bytes_popped() const
@@ -65,24 +259,116 @@ uint64_t Reader::bytes_popped() const
 string_view Reader::peek() const
 {
   // Your code here.
-  if ( !buffer_.empty() ) {
-    return std::string_view( &buffer_.front(), 1 );
+  if ( storage_ == Storage::External ) {
+    return {};
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    // front 块中尚未读取的部分
+    if ( chunks_.empty() ) {
+      return {};
+    }
+    return chunks_.front().view();
+  }
+
+  if ( storage_ == Storage::Paged ) {
+    // front 页中从读位置到页尾（或数据末尾）的部分
+    if ( pages_.empty() ) {
+      return {};
+    }
+    const uint64_t pos = bytes_read_ % PagePool::kPageSize;
+    return { pages_.front().data() + pos, min( bytes_buffered(), PagePool::kPageSize - pos ) };
+  }
+
+  // 从读位置开始，到缓冲区末尾或已写入数据末尾为止的连续区域
+  const uint64_t pos = read_pos();
+  return { ring() + pos, min( bytes_buffered(), contiguous( pos ) ) };
+}
+
+void Reader::peek_all( vector<string_view>& views ) const
+{
+  views.clear();
+  if ( bytes_buffered() == 0 || storage_ == Storage::External ) {
+    return;
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    // 每个 chunk 一段，front 块跳过已读取的部分
+    views.push_back( peek() );
+    for ( auto it = next( chunks_.begin() ); it != chunks_.end() && views.size() < IOV_MAX; ++it ) {
+      views.push_back( it->view() );
+    }
+    return;
+  }
+
+  if ( storage_ == Storage::Paged ) {
+    // 每页一段，front 页从读位置开始
+    uint64_t offset = bytes_read_ % PagePool::kPageSize;
+    uint64_t remaining = bytes_buffered();
+    for ( auto it = pages_.begin(); it != pages_.end() && remaining > 0 && views.size() < IOV_MAX; ++it ) {
+      const uint64_t n = min( remaining, PagePool::kPageSize - offset );
+      views.emplace_back( it->data() + offset, n );
+      remaining -= n;
+      offset = 0;
+    }
+    return;
+  }
+
+  // Ring 模式最多两段：读位置到缓冲区末尾，以及回绕后缓冲区开头的部分；Mirrored 模式只有一段
+  const string_view first = peek();
+  views.push_back( first );
+  if ( first.size() < bytes_buffered() ) {
+    views.emplace_back( ring(), bytes_buffered() - first.size() );
   }
-  return std::string_view();
 }
 
 void Reader::pop( uint64_t len )
 {
   // Your code here.
-  if ( len > buffer_.size() ) {
-    len = buffer_.size();
-  }
-  buffer_.erase( buffer_.begin(), buffer_.begin() + len );
+  len = min( len, bytes_buffered() );
+  const uint64_t old_page_base = page_base();
   bytes_read_ += len;
+
+  if ( storage_ == Storage::Paged ) {
+    // 读完的页立即还给 PagePool；流被读空时连最后一页也归还
+    uint64_t drop = ( page_base() - old_page_base ) / PagePool::kPageSize;
+    if ( bytes_buffered() == 0 ) {
+      drop = pages_.size();
+    }
+    pages_.erase( pages_.begin(), pages_.begin() + static_cast<ptrdiff_t>( min<uint64_t>( drop, pages_.size() ) ) );
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    // 整块读完的 chunk 直接释放，剩余部分只缩短 front 块的视图
+    while ( len > 0 && len >= chunks_.front().size() ) {
+      len -= chunks_.front().size();
+      chunks_.pop_front();
+    }
+    if ( len > 0 ) {
+      chunks_.front().remove_prefix( len );
+    }
+  }
+  // Ring 模式只需移动读计数，读位置由 bytes_read_ 推出
+}
+
+uint64_t Reader::read_into( span<char> out )
+{
+  // 依次拷贝 peek() 给出的连续区域；Ring 模式最多两段
+  uint64_t copied = 0;
+  while ( copied < out.size() && bytes_buffered() > 0 ) {
+    const string_view view = peek().substr( 0, out.size() - copied );
+    if ( view.empty() ) {
+      break; // External 模式下数据不在流中
+    }
+    memcpy( out.data() + copied, view.data(), view.size() );
+    copied += view.size();
+    pop( view.size() );
+  }
+  return copied;
 }
 
 uint64_t Reader::bytes_buffered() const
 {
   // Your code here.
-  return buffer_.size();
+  return bytes_written_ - bytes_read_;
 }
@@ -1,18 +1,38 @@
 #pragma once
 
+#include "buffer_slice.hh"
+#include "mirrored_buffer.hh"
+#include "page_pool.hh"
+#include "slab_allocator.hh"
+
 #include <algorithm>
+#include <climits>
 #include <cstdint>
 #include <deque>
 #include <iostream>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 class Reader;
 class Writer;
 
 class ByteStream
 {
 public:
-  explicit ByteStream( uint64_t capacity );
+  // 缓冲字节的存储方式
+  enum class Storage : uint8_t
+  {
+    Ring,     // 定长环形缓冲区，push 时拷贝数据
+    Chunked,  // 直接接管 push 进来的 std::string 或 BufferSlice，不拷贝数据
+    Mirrored, // 同一块内存背靠背映射两次的环形缓冲区，可读、可写区域永远是连续的；
+              // 容量不是页大小的整数倍时退化为 Ring
+    Paged,    // 按需从全局 PagePool 取定长页、读完即归还，占用的内存只和实际缓冲的字节数成正比
+    External, // 字节不经过 ByteStream（例如在内核 pipe 中用 splice 搬运），流只负责计数和容量；
+              // 只能用 reserve/commit 写入（reserve 不返回可写区域），peek 永远为空
+  };
+
+  explicit ByteStream( uint64_t capacity, Storage storage = Storage::Ring );
 
   // 访问 ByteStream 的 Reader 和 Writer 接口的辅助函数（已提供）
   Reader& reader();
@@ -24,13 +44,30 @@ public:
   void set_error() { error_ = true; };
   // 返回流是否有错误
   bool has_error() const { return error_; };
+  // 当前为缓冲数据实际分配的内存字节数
+  uint64_t memory_usage() const;
+  // 实际使用的存储方式（Mirrored 不可用时为 Ring）
+  Storage storage() const { return storage_; }
+  // 容量
+  uint64_t capacity() const { return capacity_; }
 
 protected:
   // 请将任何附加状态添加到此处的 ByteStream，而不是添加到 Writer 和 Reader 接口。
-  // 使用deque双端队列存储字节
-  std::deque<char> buffer_ {};
+  // 定长环形缓冲区，构造时从 SlabPool 一次性分配 capacity_ 个字节
+  // 读位置为 bytes_read_ % capacity_，写位置为 bytes_written_ % capacity_
+  std::vector<char, SlabAllocator<char>> buffer_ {};
+  // Mirrored 模式下代替 buffer_ 的双重映射内存
+  MirroredBuffer mirror_ {};
+  // Chunked 模式下按 push 顺序保存的数据块；读取 front 块的一部分只缩短它的视图
+  std::deque<BufferSlice> chunks_ {};
+  // 最近一次 reserve 预留的字节数；Chunked 模式下预留的内存是一个尚未入队的新块
+  uint64_t reserved_ {};
+  std::string reserved_chunk_ {};
+  // Paged 模式下的页，依次覆盖流下标 [page_base(), page_base() + pages_.size() * kPageSize)
+  std::deque<PagePool::Page> pages_ {};
   // 容量
   uint64_t capacity_;
+  Storage storage_;
   // 错误默认初始化为false
   bool error_ {};
   // 流默认状态为false，也就是打开状态
@@ -39,6 +76,19 @@ protected:
   uint64_t bytes_written_ {};
   // 读取的字节数
   uint64_t bytes_read_ {};
+
+  // 环形缓冲区中的读、写下标
+  uint64_t read_pos() const { return capacity_ ? bytes_read_ % capacity_ : 0; }
+  uint64_t write_pos() const { return capacity_ ? bytes_written_ % capacity_ : 0; }
+  // 环形缓冲区的起始地址
+  char* ring() { return storage_ == Storage::Mirrored ? mirror_.data() : buffer_.data(); }
+  const char* ring() const { return storage_ == Storage::Mirrored ? mirror_.data() : buffer_.data(); }
+  // 从下标 pos 开始最多能连续访问多少字节（Mirrored 模式下越过末尾会落到第二份映射上）
+  uint64_t contiguous( uint64_t pos ) const { return storage_ == Storage::Mirrored ? capacity_ : capacity_ - pos; }
+  // Paged 模式下第一页对应的流下标：读位置向下对齐到页边界
+  uint64_t page_base() const { return bytes_read_ / PagePool::kPageSize * PagePool::kPageSize; }
+  // Paged 模式下流下标 index 在页中的位置，所在页还没分配时在末尾补页
+  char* page_slot( uint64_t index );
 };
 
 class Writer : public ByteStream
@@ -46,8 +96,20 @@ class Writer : public ByteStream
 public:
   // 将数据推送到流中，但仅限于可用容量允许的数量。
   void push( std::string data );
+  // 同上；Chunked 模式下直接保存这个切片（与其他切片共享存储），不拷贝字节
+  void push( BufferSlice data );
+  // 在流自己的存储中预留最多 `len` 字节（不超过可用容量）的可写区域，按顺序放入 `spans`。
+  // Ring 和 Mirrored 模式下预留区域就是缓冲区本身：没有 commit 的字节原样留在那里，
+  // 之后再 reserve 覆盖同一位置时还能看到（Reassembler 的 Shared 引擎依赖这一点）
+  void reserve( uint64_t len, std::vector<std::span<char>>& spans );
+  // 确认最近一次 reserve 的区域中前 `len` 字节已经写好，使其对 Reader 可见
+  void commit( uint64_t len );
   // 指示流已到达结尾。不会再写更多的了。
   void close();
+  // 改变容量（接收缓冲区自动调整用），不小于当前缓冲的字节数；不能在 reserve 和 commit 之间调用。
+  // Ring 和 Mirrored 模式要换一块缓冲区并把缓冲的字节搬过去（新容量不是页大小的整数倍时 Mirrored 退化为 Ring），
+  // 其余模式只改容量
+  void set_capacity( uint64_t capacity );
 
   // 返回流是否已关闭
   bool is_closed() const;
@@ -55,15 +117,23 @@ public:
   uint64_t available_capacity() const;
   // 累计推送到流的总字节数
   uint64_t bytes_pushed() const;
+
+private:
+  // 把字节拷进 Ring/Mirrored/Paged 存储
+  void push_bytes( std::string_view data );
 };
 
 class Reader : public ByteStream
 {
 public:
-  // 查看缓冲区中的下一个字节
+  // 查看缓冲区中从读位置开始的最长连续可读区域（Ring 模式回绕时只返回回绕点之前的部分）
   std::string_view peek() const;
+  // 按顺序把缓冲区中所有连续可读区域放入 `views`（最多 IOV_MAX 段），可直接交给 writev
+  void peek_all( std::vector<std::string_view>& views ) const;
   // 从缓冲区中删除 `len` 字节
   void pop( uint64_t len );
+  // 把缓冲区开头最多 out.size() 个字节拷贝到 `out` 并弹出，返回拷贝的字节数（Ring 模式最多两次 memcpy）
+  uint64_t read_into( std::span<char> out );
 
   // 流是否已完成（关闭并完全弹出）？
   bool is_finished() const;
@@ -78,3 +148,9 @@ public:
  * from a ByteStream Reader into a string;
  */
 void read( Reader& reader, uint64_t len, std::string& out );
+
+/*
+ * read: pops every buffered byte and appends it to `out`, growing `out` at most once
+ * (and not at all if its capacity already suffices).
+ */
+void read( Reader& reader, std::string& out );
@@ -1,7 +1,8 @@
 #include "byte_stream.hh"
 
+#include <algorithm>
 #include <cstdint>
-#include <stdexcept>
+#include <span>
 
 /*
  * read: A helper function thats peeks and pops up to `len` bytes
@@ -9,19 +10,16 @@
  */
 void read( Reader& reader, uint64_t len, std::string& out )
 {
-  out.clear();
-
-  while ( reader.bytes_buffered() and out.size() < len ) {
-    auto view = reader.peek();
-
-    if ( view.empty() ) {
-      throw std::runtime_error( "Reader::peek() returned empty string_view" );
-    }
+  // Size the string once (reusing its capacity), then copy in bulk.
+  out.resize( std::min( len, reader.bytes_buffered() ) );
+  out.resize( reader.read_into( out ) );
+}
 
-    view = view.substr( 0, len - out.size() ); // Don't return more bytes than desired.
-    out += view;
-    reader.pop( view.size() );
-  }
+void read( Reader& reader, std::string& out )
+{
+  const size_t old_size = out.size();
+  out.resize( old_size + reader.bytes_buffered() );
+  out.resize( old_size + reader.read_into( std::span { out }.subspan( old_size ) ) );
 }
 
 Reader& ByteStream::reader()
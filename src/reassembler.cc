@@ -1,8 +1,216 @@
 #include "reassembler.hh"
 
+#include <algorithm>
+#include <cstring>
+
 using namespace std;
 
+namespace {
+
+// 把流下标区间 [begin, end) 映射到长度为 size 的环形缓冲区上，按顺序对每一段（至多两段）调用
+// f( 段起点, 段终点, 段在区间中的偏移 )；调用者保证 end - begin <= size
+template<typename F>
+void for_each_slot_range( uint64_t begin, uint64_t end, uint64_t size, F&& f )
+{
+  if ( begin >= end ) {
+    return;
+  }
+  const uint64_t pos = begin % size;
+  const uint64_t first = min( end - begin, size - pos );
+  f( pos, pos + first, uint64_t {} );
+  if ( first < end - begin ) {
+    f( uint64_t {}, end - begin - first, first );
+  }
+}
+
+} // namespace
+
+Reassembler::Reassembler( ByteStream&& output, Engine engine ) : output_( move( output ) ), engine_( engine )
+{
+  const uint64_t capacity = output_.writer().available_capacity() + output_.reader().bytes_buffered();
+  // 每个段的元数据（set 节点 + 切片的控制块）约 128 字节，按容量 / 256 限制段数，元数据不超过容量的一半
+  max_segments_ = max( kMinSegments, capacity / 256 );
+
+  // 只有 Ring 和 Mirrored 存储在 reserve 之后、commit 之前保证预留区域里的字节原样保留
+  const auto storage = output_.storage();
+  if ( engine_ == Engine::Shared && storage != ByteStream::Storage::Ring
+       && storage != ByteStream::Storage::Mirrored ) {
+    engine_ = Engine::Bitmap;
+  }
+
+  if ( engine_ != Engine::Segments ) {
+    // 窗口 [first_unassembled_index_, first_unassembled_index_ + available_capacity) 永远不超过流的容量，
+    // 窗口内的下标对容量取模互不相同
+    present_ = PresenceBitmap { capacity };
+  }
+  if ( engine_ == Engine::Bitmap ) {
+    ring_.resize( capacity );
+  }
+}
+
 void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring )
+{
+  // 只有字节要原样留下时（Segments 引擎保存乱序段，或者交给 Chunked 的输出流）才把 string 移进共享存储；
+  // 其余情况字节反正要拷进环形缓冲区或输出流，包成切片只是每段多一次 make_shared
+  if ( engine_ != Engine::Segments ) {
+    const optional<uint64_t> anchor = recent_anchor( first_index, data.size() );
+    insert_bitmap( first_index, data, is_last_substring );
+    update_recent( anchor );
+    return;
+  }
+  if ( first_index == first_unassembled_index_ && segments_.empty()
+       && output_.storage() != ByteStream::Storage::Chunked ) {
+    // 按序到达、没有保存着的段：直接推进输出流，也没有要更新的最近块
+    if ( is_last_substring ) {
+      final_index_ = first_index + data.size();
+    }
+    if ( try_append( data ) ) {
+      return;
+    }
+  }
+  insert( first_index, BufferSlice { move( data ) }, is_last_substring );
+}
+
+void Reassembler::insert( uint64_t first_index, BufferSlice data, bool is_last_substring )
+{
+  const optional<uint64_t> anchor = recent_anchor( first_index, data.size() );
+  if ( engine_ != Engine::Segments ) {
+    insert_bitmap( first_index, data.view(), is_last_substring );
+  } else {
+    insert_segments( first_index, move( data ), is_last_substring );
+  }
+  update_recent( anchor );
+}
+
+optional<uint64_t> Reassembler::recent_anchor( uint64_t first_index, uint64_t size ) const
+{
+  // 这个段落在窗口内的第一个字节：处理完之后，包含它的连续块就是最近更新的块
+  const uint64_t anchor = max( first_index, first_unassembled_index_ );
+  const bool in_window
+    = anchor < min( first_index + size, first_unassembled_index_ + output_.writer().available_capacity() );
+  return in_window ? optional { anchor } : nullopt;
+}
+
+bool Reassembler::try_append( string& data )
+{
+  if ( bytes_waiting_ != 0 || output_.writer().is_closed() ) {
+    return false;
+  }
+  // 没有保存任何乱序字节，也就没有要合并、要交付的段和要更新的最近块，不必包成切片
+  data.resize( min<uint64_t>( data.size(), output_.writer().available_capacity() ) );
+  first_unassembled_index_ += data.size();
+  if ( !data.empty() ) {
+    output_.writer().push( move( data ) );
+  }
+  close_if_done();
+  return true;
+}
+
+void Reassembler::insert_many( span<Substring> substrings )
+{
+  sort( substrings.begin(), substrings.end(), []( const Substring& a, const Substring& b ) {
+    return a.first_index < b.first_index;
+  } );
+
+  // 排序后从 first_unassembled_index_ 开始首尾相接或重叠的前 n 个子串，合起来能按序写到 end
+  const uint64_t window_end = first_unassembled_index_ + output_.writer().available_capacity();
+  uint64_t end = first_unassembled_index_;
+  size_t n = 0;
+  for ( ; n < substrings.size() && substrings[n].first_index <= end; ++n ) {
+    const Substring& sub = substrings[n];
+    end = max( end, min( sub.first_index + sub.data.size(), window_end ) );
+    if ( sub.is_last_substring ) {
+      final_index_ = sub.first_index + sub.data.size();
+    }
+  }
+
+  if ( end > first_unassembled_index_ ) {
+    discard_held( end );
+    // 一次 reserve，把每个子串中新的那部分依次拷进预留的区域，再一次 commit
+    output_.writer().reserve( end - first_unassembled_index_, spans_ );
+    auto span = spans_.begin();
+    uint64_t span_offset = 0;
+    uint64_t written = first_unassembled_index_;
+    for ( size_t i = 0; i < n && written < end; ++i ) {
+      const Substring& sub = substrings[i];
+      const uint64_t to = min( sub.first_index + sub.data.size(), end );
+      for ( ; written < to && span != spans_.end(); ) {
+        const uint64_t len = min( to - written, span->size() - span_offset );
+        memcpy( span->data() + span_offset, sub.data.data() + ( written - sub.first_index ), len );
+        written += len;
+        span_offset += len;
+        if ( span_offset == span->size() ) {
+          ++span;
+          span_offset = 0;
+        }
+      }
+      written = max( written, to );
+    }
+    output_.writer().commit( end - first_unassembled_index_ );
+    first_unassembled_index_ = end;
+  }
+  // 写完之后原来保存着的段可能接上了
+  if ( engine_ != Engine::Segments ) {
+    deliver();
+  } else {
+    check_push();
+  }
+  close_if_done();
+  update_recent( nullopt );
+
+  // 第一个空洞之后的子串只能存起来，逐个走普通的 insert
+  for ( size_t i = n; i < substrings.size(); ++i ) {
+    insert( substrings[i].first_index, move( substrings[i].data ), substrings[i].is_last_substring );
+  }
+}
+
+void Reassembler::discard_held( uint64_t end )
+{
+  if ( engine_ != Engine::Segments ) {
+    const auto discard = [&]( uint64_t from, uint64_t to, uint64_t ) {
+      bytes_waiting_ -= present_.count( from, to );
+      present_.clear( from, to );
+    };
+    for_each_slot_range( first_unassembled_index_, end, present_.size(), discard );
+    return;
+  }
+  while ( !segments_.empty() && segments_.begin()->first_index < end ) {
+    auto node = segments_.extract( segments_.begin() );
+    Seg& seg = node.value();
+    const uint64_t covered = min<uint64_t>( end - seg.first_index, seg.data.size() );
+    bytes_waiting_ -= covered;
+    if ( covered < seg.data.size() ) {
+      // 只被覆盖了前一部分：剩下的部分从 end 开始，换个键放回去（仍然排在最前面）
+      seg.data.remove_prefix( covered );
+      seg.first_index = end;
+      segments_.insert( move( node ) );
+    }
+  }
+}
+
+void Reassembler::insert_bitmap( uint64_t first_index, string_view data, bool is_last_substring )
+{
+  const uint64_t last_index = first_index + data.size();
+  if ( is_last_substring ) {
+    final_index_ = last_index;
+  }
+  // 只保留落在窗口内的部分，截断只是算下标，不动 data
+  const uint64_t begin = max( first_index, first_unassembled_index_ );
+  const uint64_t end = min( last_index, first_unassembled_index_ + output_.writer().available_capacity() );
+  if ( begin < end ) {
+    if ( begin == first_unassembled_index_ ) {
+      // 按序到达：直接写进输出流，不经过环形缓冲区；之前收到的重叠字节作废
+      discard_held( end );
+      write_output( data.data() + ( begin - first_index ), end - begin );
+      first_unassembled_index_ = end;
+    } else {
+      store( begin, data.data() + ( begin - first_index ), end - begin );
+    }
+  }
+  deliver();
+}
+
+void Reassembler::insert_segments( uint64_t first_index, BufferSlice data, bool is_last_substring )
 {
   //  const Writer& writers = writer();
   // Your code here
@@ -14,6 +222,16 @@ void Reassembler::insert( uint64_t first_index, string data, bool is_last_substr
   if ( is_last_substring ) {
     final_index_ = last_index;
   }
+  // 按序到达且没有保存着的乱序段（批量按序传输的常见情况）：截到窗口内直接交给输出流，不经过 set
+  if ( first_index == first_unassembled_index_ && segments_.empty() ) {
+    data.truncate( first_unacceptable - first_index );
+    first_unassembled_index_ += data.size();
+    if ( !data.empty() ) {
+      output_.writer().push( move( data ) );
+    }
+    close_if_done();
+    return;
+  }
   // 如果当前数据段的起始索引小于当前重组器应该处理的字节流中的下一个字节的索引
   if ( first_index < first_unassembled_index_ ) {
     // 检查当前数据段是否完全位于已处理的索引范围内：
@@ -23,10 +241,11 @@ void Reassembler::insert( uint64_t first_index, string data, bool is_last_substr
     // 因此，调用check_push尝试推送数据，并结束当前insert函数的执行。
     if ( first_index + data.size() <= first_unassembled_index_ ) {
       check_push();
+      close_if_done();
       return;
     } else {
       // 如果>的话，说明超出去的部分是不能放进去的，我们只需要把已经有序的部分放进去就好了
-      data.erase( 0, first_unassembled_index_ - first_index );
+      data.remove_prefix( first_unassembled_index_ - first_index );
       first_index = first_unassembled_index_;
     }
   }
@@ -36,24 +255,24 @@ void Reassembler::insert( uint64_t first_index, string data, bool is_last_substr
   }
   if ( last_index > first_unacceptable ) {
     //如果这个数据段的最后一个索引>第一个不能接受的索引，那我们只需要取从first_index到first_unacceptable的数据段就可以了，剩下超出去的就没必要留着了。因为已经超出capacity了
-    data.erase( first_unacceptable - first_index );
+    data.truncate( first_unacceptable - first_index );
   }
 
   if ( !segments_.empty() ) {
     //如果数据段set不为空
-    auto cur = segments_.lower_bound( Seg( first_index, "" ) );//快速找到第一个起点大于等于要插入字串的字串
+    auto cur = segments_.lower_bound( Seg( first_index, {} ) );//快速找到第一个起点大于等于要插入字串的字串
     if ( cur != segments_.begin() ) {
       //如果cur不是set集合中的第一个元素
       cur--;//cur向前移动一位,指向第一个起始索引小于first_index的数据段
       if ( cur->first_index + cur->data.size() > first_index ) {
         //如果前一个数据段的最后一个字节的索引大于first_index
         //那么就从当前要插入的数据段中删除前一个数据段已经覆盖的部分 ,可以看writeups中的check1.drawio文件
-        data.erase( 0, cur->first_index + cur->data.size() - first_index );
+        data.remove_prefix( cur->first_index + cur->data.size() - first_index );
         first_index += cur->first_index + cur->data.size() - first_index;
       }
     }
     
-    cur = segments_.lower_bound( Seg( first_index, "" ) );
+    cur = segments_.lower_bound( Seg( first_index, {} ) );
     // 再次使用 lower_bound 找到第一个起始索引大于等于 first_index 的数据段
     while ( cur != segments_.end() && cur->first_index < last_index ) {
       // 如果当前数据段完全在新插入的数据段范围内
@@ -64,22 +283,194 @@ void Reassembler::insert( uint64_t first_index, string data, bool is_last_substr
         //从segments中删除这个数据段
         segments_.erase( cur );
         //重新定位cur到新的起始索引处
-        cur = segments_.lower_bound( Seg( first_index, "" ) );
+        cur = segments_.lower_bound( Seg( first_index, {} ) );
       } else {
         //当前数据段部分重叠或完全在新插入的数据段外部，那就从新插入的数据段中删除重叠部分
-        data.erase( cur->first_index - first_index );
+        data.truncate( cur->first_index - first_index );
         break;//退出循环
       }
     }
   }
-  //全部处理完毕，把这个要插入的数据段插入到segments_中
-  segments_.insert( Seg( first_index, data ) );
+  if ( data.empty() ) {
+    // 空段不存：它要么完全被已有的段覆盖，要么是空的最后子串，只需要看看流能不能关闭
+    check_push();
+    close_if_done();
+    return;
+  }
+  //全部处理完毕，把这个要插入的数据段插入到segments_中，再和首尾相接的小段合并
   bytes_waiting_ += data.size();
+  coalesce( segments_.insert( Seg( first_index, move( data ) ) ).first );
   //推送到bytes_stream中
   check_push();
-  //  (void)first_index;
-  //  (void)data;
-  //  (void)is_last_substring;
+  // 段数超过上限时丢弃最远的段
+  evict();
+}
+
+void Reassembler::coalesce( SegmentSet::iterator it )
+{
+  // 只合并两段都小于 kCoalesceBelow 的情况：正常大小的段从不合并，不产生额外拷贝；
+  // 逐字节洪泛时每个节点至少攒够 kCoalesceBelow 字节，节点数随之下降两个数量级
+  const auto mergeable = []( const Seg& a, const Seg& b ) {
+    return a.first_index + a.data.size() == b.first_index && a.data.size() < kCoalesceBelow
+           && b.data.size() < kCoalesceBelow;
+  };
+  if ( auto next = std::next( it ); next != segments_.end() && mergeable( *it, *next ) ) {
+    it = merge( it, next );
+  }
+  if ( it != segments_.begin() ) {
+    if ( auto prev = std::prev( it ); mergeable( *prev, *it ) ) {
+      merge( prev, it );
+    }
+  }
+}
+
+Reassembler::SegmentSet::iterator Reassembler::merge( SegmentSet::iterator front, SegmentSet::iterator back )
+{
+  // 两段拼成一个新的 string；复用 front 的节点，不重新分配 set 节点
+  string joined;
+  joined.reserve( front->data.size() + back->data.size() );
+  joined.append( front->data.view() );
+  joined.append( back->data.view() );
+  segments_.erase( back );
+  auto node = segments_.extract( front );
+  node.value().data = BufferSlice { move( joined ) };
+  ++merges_;
+  return segments_.insert( move( node ) ).position;
+}
+
+void Reassembler::evict()
+{
+  // 从离 first_unassembled_index_ 最远（下标最大）的段开始丢：这些字节还没被确认，对端会重传，
+  // 而离交付点最近的段最先派上用场。丢弃顺序只取决于段的下标，同样的输入总是丢同样的段
+  while ( segments_.size() > max_segments_ ) {
+    const auto last = std::prev( segments_.end() );
+    bytes_waiting_ -= last->data.size();
+    segments_.erase( last );
+    ++evictions_;
+  }
+}
+
+Reassembler::Stats Reassembler::stats() const
+{
+  Stats ret { segments_.size(), merges_, evictions_ };
+  if ( engine_ != Engine::Segments ) {
+    // 位图里的每一段连续置位算一段
+    ret.segments_held = 0;
+    const uint64_t end = first_unassembled_index_ + present_.size();
+    for ( uint64_t index = find( true, first_unassembled_index_, end ); index < end;
+          index = find( true, index, end ) ) {
+      index = find( false, index, end );
+      ++ret.segments_held;
+    }
+  }
+  return ret;
+}
+
+Reassembler::HeldRanges Reassembler::held_ranges() const
+{
+  return HeldRanges { *this };
+}
+
+void Reassembler::RangeIterator::load( uint64_t from )
+{
+  const Reassembler& r = owner_.get();
+  if ( r.engine_ != Engine::Segments ) {
+    const uint64_t end = r.first_unassembled_index_ + r.present_.size();
+    const uint64_t first = r.find( true, max( from, r.first_unassembled_index_ ), end );
+    range_ = first == end ? Range {} : Range { first, r.find( false, first, end ) };
+    return;
+  }
+  if ( next_ == r.segments_.end() ) {
+    range_ = {};
+    return;
+  }
+  range_ = { next_->first_index, next_->first_index + next_->data.size() };
+  for ( ++next_; next_ != r.segments_.end() && next_->first_index == range_.last; ++next_ ) {
+    range_.last += next_->data.size();
+  }
+}
+
+Reassembler::Range Reassembler::extend( Range range ) const
+{
+  if ( engine_ != Engine::Segments ) {
+    // first_unassembled_index_ 处的字节一定还没收到，向前总能找到一个空洞
+    range.first = rfind( false, first_unassembled_index_, range.first ) + 1;
+    range.last = find( false, range.last, first_unassembled_index_ + present_.size() );
+    return range;
+  }
+  // 向前：包含或紧接 range.first 的段都并进来
+  for ( auto it = segments_.upper_bound( Seg( range.first, {} ) ); it != segments_.begin(); ) {
+    --it;
+    if ( it->first_index + it->data.size() < range.first ) {
+      break;
+    }
+    range.first = it->first_index;
+    range.last = max( range.last, it->first_index + it->data.size() );
+  }
+  // 向后：包含 range.last - 1 的段（重叠的新段可能替换掉块里原来的段、伸出 range.last）和之后首尾相接的段
+  for ( auto it = prev( segments_.upper_bound( Seg( range.last - 1, {} ) ) );
+        it != segments_.end() && it->first_index <= range.last;
+        ++it ) {
+    range.last = max( range.last, it->first_index + it->data.size() );
+  }
+  return range;
+}
+
+void Reassembler::update_recent( optional<uint64_t> anchor )
+{
+  // 交付只会吃掉整块（块从 first_unassembled_index_ 之后开始，一旦被追上就整块交付），
+  // 丢弃只会从最高的下标往下砍，所以把每块截到还保存着的最高下标即可
+  uint64_t held_end = UINT64_MAX;
+  if ( engine_ == Engine::Segments ) {
+    const auto last = segments_.rbegin();
+    held_end = last == segments_.rend() ? 0 : last->first_index + last->data.size();
+  }
+  const auto stale = [&]( Range& range ) {
+    range.last = min( range.last, held_end );
+    return range.last <= max( range.first, first_unassembled_index_ );
+  };
+  recent_count_ = static_cast<size_t>( remove_if( recent_.begin(), recent_.begin() + recent_count_, stale )
+                                       - recent_.begin() );
+
+  if ( !anchor || *anchor < first_unassembled_index_ || *anchor >= held_end ) {
+    return;
+  }
+  // 以包含 anchor 的旧块为起点向两边扩展：批量乱序到达时新段通常紧接着最近的块，只需查一两个邻居
+  Range seed { *anchor, *anchor + 1 };
+  for ( size_t i = 0; i < recent_count_; ++i ) {
+    if ( recent_[i].first <= *anchor && *anchor < recent_[i].last ) {
+      seed = recent_[i];
+    }
+  }
+  const Range block = extend( seed );
+
+  // 被新块吞并的旧块去掉，新块放到最前面，超出 kRecentRanges 的最旧的块挤出去
+  const auto inside = [&]( const Range& range ) { return block.first <= range.first && range.last <= block.last; };
+  recent_count_ = static_cast<size_t>( remove_if( recent_.begin(), recent_.begin() + recent_count_, inside )
+                                       - recent_.begin() );
+  recent_count_ = min( recent_count_ + 1, kRecentRanges );
+  move_backward( recent_.begin(), recent_.begin() + recent_count_ - 1, recent_.begin() + recent_count_ );
+  recent_[0] = block;
+}
+
+bool Reassembler::set_capacity( uint64_t capacity )
+{
+  if ( bytes_waiting_ != 0 && ( engine_ != Engine::Segments || capacity < output_.capacity() ) ) {
+    return false;
+  }
+  output_.writer().set_capacity( capacity );
+  capacity = output_.capacity();
+  if ( !max_segments_fixed_ ) {
+    // 缩小时不会保存着乱序段（见上），不用丢弃
+    max_segments_ = max( kMinSegments, capacity / 256 );
+  }
+  if ( engine_ != Engine::Segments ) {
+    present_ = PresenceBitmap { capacity };
+  }
+  if ( engine_ == Engine::Bitmap ) {
+    ring_ = vector<char>( capacity );
+  }
+  return true;
 }
 
 uint64_t Reassembler::bytes_pending() const
@@ -101,15 +492,14 @@ void Reassembler::check_push()
   检查索引：if ( seg->first_index == first_unassembled_index_ ) 检查这个数据段的 first_index 是否恰好是
 first_unassembled_index_，即重组器当前应该处理的字节流的索引。
 
-    推送数据：如果索引匹配，output_.writer().push( seg->data ); 将数据段的内容 seg->data 推送到 ByteStream 的写端。
-
-  保存迭代器：auto tmp = seg; 保存当前 seg 迭代器的副本，因为接下来的操作可能会使 seg 迭代器失效。
+    取出并推送数据：如果索引匹配，auto node = segments_.extract( seg ); 把这个数据段的节点从 segments_
+中摘下来（同时完成删除），然后 output_.writer().push( move( node.value().data ) ); 把 data 移动给 ByteStream 的写端，
+不再拷贝一次（Chunked 模式的 ByteStream 会直接接管这个切片）。
 
   更新索引和计数器：
 
-    first_unassembled_index_ += seg->data.size(); 更新
-first_unassembled_index_，它指向下一个需要处理的数据字节的索引。 bytes_waiting_ -= seg->data.size();
-减少等待重组的字节数。 删除段：segments_.erase( tmp ); 从 segments_ 集合中删除已经推送的数据段。
+    first_unassembled_index_ += len; 更新 first_unassembled_index_，它指向下一个需要处理的数据字节的索引。
+bytes_waiting_ -= len; 减少等待重组的字节数。
 
   关闭输出：如果 first_unassembled_index_ 已经达到或超过了 final_index_（表示所有数据段都已重组完毕），则调用
 output_.writer().close(); 关闭 ByteStream 的写端。
@@ -120,11 +510,12 @@ first_unassembled_index_，说明没有更多的数据段可以推送，因此
   while ( !segments_.empty() ) {
     auto seg = segments_.begin();
     if ( seg->first_index == first_unassembled_index_ ) {
-      output_.writer().push( seg->data );
-      auto tmp = seg;
-      first_unassembled_index_ += seg->data.size();
-      bytes_waiting_ -= seg->data.size();
-      segments_.erase( tmp );
+      // 用 extract 取出节点后把切片移动给 ByteStream，避免再拷贝一次
+      auto node = segments_.extract( seg );
+      const uint64_t len = node.value().data.size();
+      output_.writer().push( move( node.value().data ) );
+      first_unassembled_index_ += len;
+      bytes_waiting_ -= len;
       if ( first_unassembled_index_ >= final_index_ ) {
         output_.writer().close();
       }
@@ -132,4 +523,114 @@ first_unassembled_index_，说明没有更多的数据段可以推送，因此
       break;
     }
   }
-}
\ No newline at end of file
+}
+void Reassembler::write_output( const char* data, uint64_t len )
+{
+  output_.writer().reserve( len, spans_ );
+  uint64_t copied = 0;
+  for ( const auto& span : spans_ ) {
+    memcpy( span.data(), data + copied, span.size() );
+    copied += span.size();
+  }
+  output_.writer().commit( len );
+}
+
+void Reassembler::copy_to_reserved( uint64_t offset, const char* data, uint64_t len )
+{
+  for ( const auto& span : spans_ ) {
+    if ( len == 0 ) {
+      break;
+    }
+    if ( offset >= span.size() ) {
+      offset -= span.size();
+      continue;
+    }
+    const uint64_t n = min( len, span.size() - offset );
+    memcpy( span.data() + offset, data, n );
+    data += n;
+    len -= n;
+    offset = 0;
+  }
+}
+
+uint64_t Reassembler::find( bool value, uint64_t begin, uint64_t end ) const
+{
+  uint64_t found = end;
+  for_each_slot_range( begin, end, present_.size(), [&]( uint64_t from, uint64_t to, uint64_t offset ) {
+    if ( found == end ) {
+      const uint64_t hit = present_.find( value, from, to );
+      if ( hit < to ) {
+        found = begin + offset + ( hit - from );
+      }
+    }
+  } );
+  return found;
+}
+
+uint64_t Reassembler::rfind( bool value, uint64_t begin, uint64_t end ) const
+{
+  // 各段按流下标从小到大给出，最后一个命中的段里的结果就是整个区间的最后一个
+  uint64_t found = end;
+  for_each_slot_range( begin, end, present_.size(), [&]( uint64_t from, uint64_t to, uint64_t offset ) {
+    const uint64_t hit = present_.rfind( value, from, to );
+    if ( hit < to ) {
+      found = begin + offset + ( hit - from );
+    }
+  } );
+  return found;
+}
+
+void Reassembler::store( uint64_t first_index, const char* data, uint64_t len )
+{
+  // 只拷贝还没收到的空洞，已有的字节（重复或重叠的部分）跳过
+  const uint64_t end = first_index + len;
+  if ( engine_ == Engine::Shared ) {
+    if ( output_.writer().is_closed() || output_.has_error() ) {
+      return;
+    }
+    // 预留从 first_unassembled_index_ 到 end 的空闲空间：乱序字节直接拷到它们在输出流中的最终位置，
+    // 空洞补上之后只需 commit，不再拷贝
+    output_.writer().reserve( end - first_unassembled_index_, spans_ );
+  }
+  for ( uint64_t index = find( false, first_index, end ); index < end; ) {
+    const uint64_t filled = find( true, index, end );
+    if ( engine_ == Engine::Shared ) {
+      copy_to_reserved( index - first_unassembled_index_, data + ( index - first_index ), filled - index );
+    }
+    for_each_slot_range( index, filled, present_.size(), [&]( uint64_t from, uint64_t to, uint64_t offset ) {
+      if ( engine_ == Engine::Bitmap ) {
+        memcpy( ring_.data() + from, data + ( index - first_index ) + offset, to - from );
+      }
+      present_.set( from, to );
+    } );
+    bytes_waiting_ += filled - index;
+    index = filled == end ? end : find( false, filled, end );
+  }
+}
+
+void Reassembler::deliver()
+{
+  const uint64_t begin = first_unassembled_index_;
+  const uint64_t end = find( false, begin, begin + present_.size() );
+  if ( engine_ == Engine::Shared && end > begin ) {
+    // 字节已经在输出流里了，只需让 Reader 看见
+    output_.writer().reserve( end - begin, spans_ );
+    output_.writer().commit( end - begin );
+  }
+  for_each_slot_range( begin, end, present_.size(), [&]( uint64_t from, uint64_t to, uint64_t ) {
+    if ( engine_ == Engine::Bitmap ) {
+      write_output( ring_.data() + from, to - from );
+    }
+    present_.clear( from, to );
+  } );
+  bytes_waiting_ -= end - begin;
+  first_unassembled_index_ = end;
+  close_if_done();
+}
+
+void Reassembler::close_if_done()
+{
+  if ( first_unassembled_index_ >= final_index_ && !output_.writer().is_closed() ) {
+    output_.writer().close();
+  }
+}
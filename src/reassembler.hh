@@ -1,7 +1,17 @@
 #pragma once
 #include "byte_stream.hh"
+#include "presence_bitmap.hh"
+#include "slab_allocator.hh"
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iterator>
+#include <optional>
 #include <set>
+#include <span>
+#include <string_view>
 #include <utility>
+#include <vector>
 /**
  * 这个实验室检查点（Lab
 Checkpoint）是CS144课程《计算机网络导论》的一部分，主题是计算机网络，特别是关于传输控制协议（TCP）的实现。以下是主要要求和实现目标的概述：
@@ -50,8 +60,19 @@ Gbit/s的处理速度。
 class Reassembler
 {
 public:
+  // 乱序字节的存放方式
+  enum class Engine : uint8_t
+  {
+    Segments, // 有序 set 保存互不重叠的乱序段
+    Bitmap,   // 与输出流容量等长的环形缓冲区 + 存在位图：插入只是一次 memcpy 加位图置位，
+              // 交付时从 first_unassembled_index_ 开始找第一个未置位的位
+    Shared,   // 同 Bitmap，但乱序字节直接写进输出流的空闲空间（下标 - first_unassembled_index_ 处），
+              // 空洞补上后 commit 即可，每个字节只拷贝一次，也不需要自己的环形缓冲区；
+              // 只支持 Ring 和 Mirrored 存储，其他存储退化为 Bitmap
+  };
+
   // Construct Reassembler to write into given ByteStream.
-  explicit Reassembler( ByteStream&& output ) : output_( std::move( output ) ) {};
+  explicit Reassembler( ByteStream&& output, Engine engine = Engine::Segments );
 
   /*
    * Insert a new substring to be reassembled into a ByteStream.
@@ -75,9 +96,80 @@ public:
    */
   void insert( uint64_t first_index, std::string data, bool is_last_substring );
 
+  /*
+   * The same, for a payload that is a slice of a shared buffer. Trimming the slice to the window or around
+   * stored segments only moves its offsets, and with a Chunked output stream the stored slice is handed to
+   * the stream as is, so the payload bytes are never copied.
+   */
+  void insert( uint64_t first_index, BufferSlice data, bool is_last_substring );
+
+  // 一批子串中的一个（recvmmsg 一次唤醒能取出 32~64 个报文）
+  struct Substring
+  {
+    uint64_t first_index {};
+    BufferSlice data {};
+    bool is_last_substring {};
+  };
+
+  /*
+   * Insert a batch of substrings, delivering the same bytes as inserting them one by one. The batch is sorted
+   * by index once (in place); the bytes that continue the stream from the next expected index, across
+   * however many substrings, are written to the output with a single reserve/commit, and only the
+   * substrings beyond the first gap go through insert() one at a time.
+   */
+  void insert_many( std::span<Substring> substrings );
+
+  /*
+   * Fast path for a payload that continues the stream exactly at the next expected index when nothing is
+   * held out of order: the bytes are pushed straight into the output (truncated to its available capacity)
+   * and true is returned. Otherwise nothing happens and false is returned; the caller falls back to insert().
+   */
+  bool try_append( std::string& data );
+
   // How many bytes are stored in the Reassembler itself?
   uint64_t bytes_pending() const;
 
+  // 乱序段的元数据开销
+  struct Stats
+  {
+    uint64_t segments_held {}; // 当前保存的段数（Bitmap 和 Shared 引擎为位图中连续置位的段数）
+    uint64_t merges {};        // 累计把首尾相接的小段合并的次数
+    uint64_t evictions {};     // 累计因段数超过上限而丢弃的段数
+  };
+  Stats stats() const;
+
+  // 一段连续收到、但还没交付的字节 [first, last)
+  struct Range
+  {
+    uint64_t first {};
+    uint64_t last {};
+    uint64_t size() const { return last - first; }
+    bool operator==( const Range& other ) const = default;
+  };
+
+  // 按下标从小到大遍历保存着的乱序字节：首尾相接的段合成一个 Range（正好是一个 SACK 块）。
+  // 遍历不分配内存；遍历期间不能 insert
+  class RangeIterator;
+  class HeldRanges;
+  HeldRanges held_ranges() const;
+
+  // 最近更新过的至多 kRecentRanges 个 Range，最近的在前：RFC 2018 要求第一个 SACK 块包含触发这次 ACK 的段，
+  // 其余的块按最近报告过的顺序重复。每次 insert 顺带维护，不用遍历整个结构
+  static constexpr size_t kRecentRanges = 4;
+  std::span<const Range> recent_ranges() const { return { recent_.data(), recent_count_ }; }
+
+  // 改变输出流的容量（接收缓冲区自动调整用）。Bitmap 和 Shared 引擎按容量取模存放乱序字节，
+  // 保存着乱序字节时不能改；Segments 引擎这时只能扩大。做不到时返回 false，调用者稍后再试
+  bool set_capacity( uint64_t capacity );
+
+  // 最多保存多少个乱序段（默认 max(64, 容量 / 256)，随 set_capacity() 重算；设置过之后就不再重算）；
+  // 超过时从下标最大的段开始丢弃
+  void set_max_segments( uint64_t max_segments )
+  {
+    max_segments_ = std::max<uint64_t>( max_segments, 1 );
+    max_segments_fixed_ = true;
+  }
+
   // Access output stream reader
   Reader& reader() { return output_.reader(); }
   const Reader& reader() const { return output_.reader(); }
@@ -90,14 +182,119 @@ private:
   struct Seg
   {
     uint64_t first_index;// 表示该数据段在原始字节流中的起始索引
-    std::string data;
+    BufferSlice data;
     bool operator<( const Seg& other ) const { return first_index < other.first_index; }
-    Seg( uint64_t f, std::string  d ) : first_index( f ), data(std::move( d )) {};
+    Seg( uint64_t f, BufferSlice d ) : first_index( f ), data(std::move( d )) {};
   };
-  std::set<Seg> segments_ {};
+  // set 的节点从 SlabPool 分配，每收到一个乱序段不必再走一次全局堆
+  using SegmentSet = std::set<Seg, std::less<Seg>, SlabAllocator<Seg>>;
+  SegmentSet segments_ {};
   uint64_t bytes_waiting_ {};
   uint64_t first_unpoped_index_ {};
   uint64_t first_unassembled_index_ {};//当前重组器应该处理的字节流中的下一个字节的索引
   uint64_t final_index_ = INT64_MAX;
   void check_push();
+
+  // 两段都小于这个长度且首尾相接时合并成一段
+  static constexpr uint64_t kCoalesceBelow = 128;
+  static constexpr uint64_t kMinSegments = 64;
+  uint64_t max_segments_ {};
+  bool max_segments_fixed_ {}; // 调用过 set_max_segments()
+  uint64_t merges_ {};
+  uint64_t evictions_ {};
+  // 把新插入的段 it 与首尾相接的前后小段合并
+  void coalesce( SegmentSet::iterator it );
+  // 把 front 和紧随其后的 back 合成一段，返回合并后的段
+  SegmentSet::iterator merge( SegmentSet::iterator front, SegmentSet::iterator back );
+  // 段数超过 max_segments_ 时丢弃下标最大的段
+  void evict();
+
+  // Bitmap 引擎：流下标 i 的字节放在 ring_[i % ring_.size()]，present_ 的对应位表示它是否已收到；
+  // Shared 引擎没有 ring_，字节放在输出流的预留区域里
+  Engine engine_;
+  std::vector<char> ring_ {};
+  PresenceBitmap present_ {};
+  std::vector<std::span<char>> spans_ {}; // 复用的 reserve 结果，避免每次交付都分配
+  // 把 len 个字节拷进输出流自己的存储（reserve + commit，只拷贝一次）
+  void write_output( const char* data, uint64_t len );
+  // 把 spans_ 看成一段连续内存，从 offset 开始拷入 len 个字节
+  void copy_to_reserved( uint64_t offset, const char* data, uint64_t len );
+  // 把 [first_index, first_index + len) 中还没收到的字节拷进环形缓冲区或输出流（调用者保证整段都在窗口内）
+  void store( uint64_t first_index, const char* data, uint64_t len );
+  // 流下标 [begin, end) 中第一个存在位等于 value 的下标，没有则返回 end
+  uint64_t find( bool value, uint64_t begin, uint64_t end ) const;
+  // 流下标 [begin, end) 中最后一个存在位等于 value 的下标，没有则返回 end
+  uint64_t rfind( bool value, uint64_t begin, uint64_t end ) const;
+  // 把从 first_unassembled_index_ 开始连续收到的字节一次写进输出流
+  void deliver();
+  void close_if_done();
+
+  // 丢掉保存着的 [first_unassembled_index_, end) 中的字节：它们马上要按序直接写进输出流
+  void discard_held( uint64_t end );
+
+  void insert_segments( uint64_t first_index, BufferSlice data, bool is_last_substring );
+  void insert_bitmap( uint64_t first_index, std::string_view data, bool is_last_substring );
+
+  // 最近更新过的 Range，最近的在前
+  std::array<Range, kRecentRanges> recent_ {};
+  size_t recent_count_ {};
+  // 一个段落在窗口内的第一个字节，整段都在窗口外时为空
+  std::optional<uint64_t> recent_anchor( uint64_t first_index, uint64_t size ) const;
+  // 去掉 recent_ 中已交付或被丢弃的部分；anchor 是这次插入落在窗口内的第一个字节（没有则为空），
+  // 把它所在的 Range 放到最前面
+  void update_recent( std::optional<uint64_t> anchor );
+  // 把 range 扩展成包含它的最大连续块（range 中的字节都已收到）
+  Range extend( Range range ) const;
+};
+
+class Reassembler::RangeIterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Range;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Range*;
+  using reference = const Range&;
+
+  const Range& operator*() const { return range_; }
+  const Range* operator->() const { return &range_; }
+  RangeIterator& operator++()
+  {
+    load( range_.last );
+    return *this;
+  }
+  RangeIterator operator++( int )
+  {
+    RangeIterator old = *this;
+    load( range_.last );
+    return old;
+  }
+  bool operator==( const RangeIterator& other ) const { return range_ == other.range_; }
+
+private:
+  friend class Reassembler;
+  explicit RangeIterator( const Reassembler& owner ) : owner_( owner ), next_( owner.segments_.begin() ) {}
+  // 找从流下标 from 开始的下一个 Range，没有时 range_ 置空
+  void load( uint64_t from );
+
+  std::reference_wrapper<const Reassembler> owner_;
+  SegmentSet::const_iterator next_; // Segments 引擎：还没并进 range_ 的第一个段
+  Range range_ {};                  // 空 Range 表示遍历结束
+};
+
+class Reassembler::HeldRanges
+{
+public:
+  RangeIterator begin() const
+  {
+    RangeIterator it { owner_ };
+    it.load( owner_.get().first_unassembled_index_ );
+    return it;
+  }
+  RangeIterator end() const { return RangeIterator { owner_ }; }
+
+private:
+  friend class Reassembler;
+  explicit HeldRanges( const Reassembler& owner ) : owner_( owner ) {}
+  std::reference_wrapper<const Reassembler> owner_;
 };
@@ -0,0 +1,198 @@
+#include "spsc_byte_stream.hh"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+SPSCByteStream::SPSCByteStream( uint64_t capacity, bool wakeups )
+  : buffer_( capacity ), capacity_( capacity ), wakeups_( wakeups )
+{}
+
+void SPSCByteStream::set_error()
+{
+  error_.store( true, memory_order_release );
+  // 两端都可能在等待，全部唤醒让它们看到错误
+  wake_reader();
+  wake_writer();
+}
+
+void SPSCByteStream::wake_reader()
+{
+  if ( !wakeups_ ) {
+    return;
+  }
+  // 与 wait_readable() 中的屏障配对：要么这里看到读端立起的标志，要么读端检查条件时看到刚发布的数据
+  atomic_thread_fence( memory_order_seq_cst );
+  if ( reader_waiting_.load( memory_order_relaxed ) ) {
+    data_seq_.fetch_add( 1, memory_order_release );
+    data_seq_.notify_one();
+  }
+}
+
+void SPSCByteStream::wake_writer()
+{
+  if ( !wakeups_ ) {
+    return;
+  }
+  atomic_thread_fence( memory_order_seq_cst );
+  if ( writer_waiting_.load( memory_order_relaxed ) ) {
+    space_seq_.fetch_add( 1, memory_order_release );
+    space_seq_.notify_one();
+  }
+}
+
+void SPSCByteStream::Writer::push( string data )
+{
+  if ( closed_.load( memory_order_relaxed ) || has_error() ) {
+    set_error();
+    return;
+  }
+
+  const uint64_t written = bytes_written_.load( memory_order_relaxed );
+  // 先用缓存的读计数算空间，不够时才去读对端的 cache line
+  if ( data.size() > capacity_ - ( written - cached_bytes_read_ ) ) {
+    cached_bytes_read_ = bytes_read_.load( memory_order_acquire );
+  }
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), capacity_ - ( written - cached_bytes_read_ ) );
+  if ( len == 0 ) {
+    return;
+  }
+
+  const uint64_t pos = written % capacity_;
+  const uint64_t first = min( len, capacity_ - pos );
+  memcpy( buffer_.data() + pos, data.data(), first );
+  memcpy( buffer_.data(), data.data() + first, len - first );
+
+  // release：读端看到新的写计数时，上面拷贝的字节一定已经可见
+  bytes_written_.store( written + len, memory_order_release );
+  wake_reader();
+}
+
+void SPSCByteStream::Writer::close()
+{
+  closed_.store( true, memory_order_release );
+  wake_reader();
+}
+
+bool SPSCByteStream::Writer::is_closed() const
+{
+  return closed_.load( memory_order_acquire );
+}
+
+uint64_t SPSCByteStream::Writer::available_capacity() const
+{
+  return capacity_
+         - ( bytes_written_.load( memory_order_relaxed ) - bytes_read_.load( memory_order_acquire ) );
+}
+
+uint64_t SPSCByteStream::Writer::bytes_pushed() const
+{
+  return bytes_written_.load( memory_order_relaxed );
+}
+
+void SPSCByteStream::Writer::wait_writable()
+{
+  // 先立标志、再取序号、最后检查条件：检查之后对端的任何 pop 都会看到标志并改变序号，wait 不会错过唤醒
+  writer_waiting_.store( true, memory_order_relaxed );
+  atomic_thread_fence( memory_order_seq_cst );
+  while ( true ) {
+    const uint32_t seq = space_seq_.load( memory_order_acquire );
+    if ( available_capacity() > 0 || has_error() ) {
+      break;
+    }
+    space_seq_.wait( seq, memory_order_acquire );
+  }
+  writer_waiting_.store( false, memory_order_relaxed );
+}
+
+string_view SPSCByteStream::Reader::peek() const
+{
+  const uint64_t read = bytes_read_.load( memory_order_relaxed );
+  const uint64_t buffered = bytes_written_.load( memory_order_acquire ) - read;
+  if ( buffered == 0 ) {
+    return {};
+  }
+  const uint64_t pos = read % capacity_;
+  return { buffer_.data() + pos, min( buffered, capacity_ - pos ) };
+}
+
+void SPSCByteStream::Reader::pop( uint64_t len )
+{
+  const uint64_t read = bytes_read_.load( memory_order_relaxed );
+  // 先用缓存的写计数判断，不够时才去读对端的 cache line
+  if ( len > cached_bytes_written_ - read ) {
+    cached_bytes_written_ = bytes_written_.load( memory_order_acquire );
+  }
+  len = min( len, cached_bytes_written_ - read );
+  if ( len == 0 ) {
+    return;
+  }
+
+  // release：写端看到新的读计数时，这些字节已经被读完，可以安全覆盖
+  bytes_read_.store( read + len, memory_order_release );
+  wake_writer();
+}
+
+bool SPSCByteStream::Reader::is_finished() const
+{
+  // 先看关闭标志再看写计数：close() 之前的所有写入在看到 closed_ 时都已可见
+  return closed_.load( memory_order_acquire ) && bytes_buffered() == 0;
+}
+
+uint64_t SPSCByteStream::Reader::bytes_buffered() const
+{
+  return bytes_written_.load( memory_order_acquire ) - bytes_read_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCByteStream::Reader::bytes_popped() const
+{
+  return bytes_read_.load( memory_order_relaxed );
+}
+
+void SPSCByteStream::Reader::wait_readable()
+{
+  // 与 wait_writable() 相同，先立标志、再取序号、最后检查条件
+  reader_waiting_.store( true, memory_order_relaxed );
+  atomic_thread_fence( memory_order_seq_cst );
+  while ( true ) {
+    const uint32_t seq = data_seq_.load( memory_order_acquire );
+    if ( bytes_buffered() > 0 || closed_.load( memory_order_acquire ) || has_error() ) {
+      break;
+    }
+    data_seq_.wait( seq, memory_order_acquire );
+  }
+  reader_waiting_.store( false, memory_order_relaxed );
+}
+
+SPSCByteStream::Reader& SPSCByteStream::reader()
+{
+  static_assert( sizeof( Reader ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCByteStream Reader." );
+
+  return static_cast<Reader&>( *this ); // NOLINT(*-downcast)
+}
+
+const SPSCByteStream::Reader& SPSCByteStream::reader() const
+{
+  static_assert( sizeof( Reader ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCByteStream Reader." );
+
+  return static_cast<const Reader&>( *this ); // NOLINT(*-downcast)
+}
+
+SPSCByteStream::Writer& SPSCByteStream::writer()
+{
+  static_assert( sizeof( Writer ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCByteStream Writer." );
+
+  return static_cast<Writer&>( *this ); // NOLINT(*-downcast)
+}
+
+const SPSCByteStream::Writer& SPSCByteStream::writer() const
+{
+  static_assert( sizeof( Writer ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCByteStream Writer." );
+
+  return static_cast<const Writer&>( *this ); // NOLINT(*-downcast)
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * SPSCByteStream: 供一个写线程和一个读线程同时使用的 ByteStream。
+ *
+ * 接口与 ByteStream 的 Reader/Writer 相同，但内部不加锁：读写计数是原子变量，
+ * 写端只修改 bytes_written_，读端只修改 bytes_read_，两者分别放在独立的 cache line 上，
+ * 避免两个核心来回争抢同一行。存储是定长环形缓冲区，与 ByteStream 的 Ring 模式一致。
+ *
+ * 构造时打开 wakeups 后，读端可以用 wait_readable() 阻塞等待数据，写端可以用 wait_writable()
+ * 阻塞等待空间（基于 std::atomic::wait，在 Linux 上即 futex）；不打开时不会有任何唤醒开销。
+ * 等待的一方先在自己的 cache line 上立一个"正在等待"标志，对端只在看到标志时才更新序号并 notify，
+ * 所以对端没有阻塞时，push()/pop() 只多一次屏障和一次读，没有原子读改写，也没有系统调用。
+ */
+class SPSCByteStream
+{
+public:
+  class Reader;
+  class Writer;
+
+  explicit SPSCByteStream( uint64_t capacity, bool wakeups = false );
+
+  Reader& reader();
+  const Reader& reader() const;
+  Writer& writer();
+  const Writer& writer() const;
+
+  void set_error();
+  bool has_error() const { return error_.load( std::memory_order_acquire ); }
+
+  // 原子变量不可复制，跨线程共享的流也不应被复制
+  SPSCByteStream( const SPSCByteStream& other ) = delete;
+  SPSCByteStream& operator=( const SPSCByteStream& other ) = delete;
+
+protected:
+  static constexpr size_t kCacheLineSize = 64;
+
+  std::vector<char> buffer_;
+  uint64_t capacity_;
+  bool wakeups_;
+
+  // 写端独占的 cache line：写入计数、关闭标志、写端缓存的读计数、"有新数据"的唤醒序号，以及写端在等空间的标志
+  alignas( kCacheLineSize ) std::atomic<uint64_t> bytes_written_ {};
+  std::atomic<bool> closed_ {};
+  uint64_t cached_bytes_read_ {};
+  std::atomic<uint32_t> data_seq_ {};
+  std::atomic<bool> writer_waiting_ {};
+
+  // 读端独占的 cache line：读取计数、读端缓存的写计数、"有新空间"的唤醒序号，以及读端在等数据的标志
+  alignas( kCacheLineSize ) std::atomic<uint64_t> bytes_read_ {};
+  uint64_t cached_bytes_written_ {};
+  std::atomic<uint32_t> space_seq_ {};
+  std::atomic<bool> reader_waiting_ {};
+
+  // 对端正在等待时，唤醒在 data_seq_ / space_seq_ 上等待的对端
+  void wake_reader();
+  void wake_writer();
+
+  alignas( kCacheLineSize ) std::atomic<bool> error_ {};
+};
+
+class SPSCByteStream::Writer : public SPSCByteStream
+{
+public:
+  void push( std::string data );
+  void close();
+
+  bool is_closed() const;
+  uint64_t available_capacity() const;
+  uint64_t bytes_pushed() const;
+
+  // 阻塞直到有可写空间或流出错（需要在构造时打开 wakeups）
+  void wait_writable();
+};
+
+class SPSCByteStream::Reader : public SPSCByteStream
+{
+public:
+  std::string_view peek() const;
+  void pop( uint64_t len );
+
+  bool is_finished() const;
+  uint64_t bytes_buffered() const;
+  uint64_t bytes_popped() const;
+
+  // 阻塞直到有数据可读、流已关闭或出错（需要在构造时打开 wakeups）
+  void wait_readable();
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+
+/*
+ * StaticByteStream<N>: 容量在编译期确定、存储内联在对象里的 ByteStream。
+ *
+ * 接口与 ByteStream 的 Reader/Writer 相同（push 接受 string_view，传 std::string 也能直接调用），
+ * 但构造时不做任何堆分配，也不清零缓冲区：适合大量短小的控制流，可以直接放在栈上或数组里。
+ * N 是 2 的幂时，环形下标用 & (N - 1) 代替 % N，在编译期就确定下来。
+ */
+template<uint64_t N>
+class StaticByteStream
+{
+  static_assert( N > 0, "StaticByteStream needs a nonzero capacity" );
+
+public:
+  class Reader;
+  class Writer;
+
+  Reader& reader()
+  {
+    static_assert( sizeof( Reader ) == sizeof( StaticByteStream ),
+                   "Please add member variables to the StaticByteStream base, not the StaticByteStream Reader." );
+
+    return static_cast<Reader&>( *this ); // NOLINT(*-downcast)
+  }
+
+  const Reader& reader() const
+  {
+    static_assert( sizeof( Reader ) == sizeof( StaticByteStream ),
+                   "Please add member variables to the StaticByteStream base, not the StaticByteStream Reader." );
+
+    return static_cast<const Reader&>( *this ); // NOLINT(*-downcast)
+  }
+
+  Writer& writer()
+  {
+    static_assert( sizeof( Writer ) == sizeof( StaticByteStream ),
+                   "Please add member variables to the StaticByteStream base, not the StaticByteStream Writer." );
+
+    return static_cast<Writer&>( *this ); // NOLINT(*-downcast)
+  }
+
+  const Writer& writer() const
+  {
+    static_assert( sizeof( Writer ) == sizeof( StaticByteStream ),
+                   "Please add member variables to the StaticByteStream base, not the StaticByteStream Writer." );
+
+    return static_cast<const Writer&>( *this ); // NOLINT(*-downcast)
+  }
+
+  void set_error() { error_ = true; }
+  bool has_error() const { return error_; }
+
+  static constexpr uint64_t capacity() { return N; }
+
+protected:
+  static constexpr bool kPowerOfTwo = ( N & ( N - 1 ) ) == 0;
+
+  // 流下标在环形缓冲区中的位置
+  static constexpr uint64_t slot( uint64_t index )
+  {
+    if constexpr ( kPowerOfTwo ) {
+      return index & ( N - 1 );
+    } else {
+      return index % N;
+    }
+  }
+
+  // 按 16 字节分块拷贝。直接 memcpy 时长度有编译期上界 N，GCC 会把它内联成 rep movs，
+  // 短拷贝的启动开销反而比调用 libc 的 memcpy 还大
+  static void copy( char* dst, const char* src, uint64_t len )
+  {
+    for ( ; len >= 16; dst += 16, src += 16, len -= 16 ) {
+      std::memcpy( dst, src, 16 );
+    }
+    std::memcpy( dst, src, len );
+  }
+
+  uint64_t bytes_written_ {};
+  uint64_t bytes_read_ {};
+  bool closed_ {};
+  bool error_ {};
+  // 缓冲区故意不初始化（没有被写过的字节永远不会被读到）：用 `StaticByteStream<N> bs;` 默认初始化时，
+  // 构造只需清零几个计数器；写成 `bs {}` 值初始化则会把整个缓冲区清零
+  alignas( 16 ) char buffer_[N]; // NOLINT(*-avoid-c-arrays, *-member-init)
+};
+
+template<uint64_t N>
+class StaticByteStream<N>::Writer : public StaticByteStream<N>
+{
+public:
+  void push( std::string_view data )
+  {
+    if ( this->closed_ || this->error_ ) {
+      this->set_error();
+      return;
+    }
+    const uint64_t len = std::min( static_cast<uint64_t>( data.size() ), available_capacity() );
+    if ( len == 0 ) {
+      return;
+    }
+    const uint64_t pos = this->slot( this->bytes_written_ );
+    const uint64_t first = std::min( len, N - pos );
+    this->copy( this->buffer_ + pos, data.data(), first );
+    this->copy( this->buffer_, data.data() + first, len - first );
+    this->bytes_written_ += len;
+  }
+
+  void close() { this->closed_ = true; }
+
+  bool is_closed() const { return this->closed_; }
+  uint64_t available_capacity() const { return N - ( this->bytes_written_ - this->bytes_read_ ); }
+  uint64_t bytes_pushed() const { return this->bytes_written_; }
+};
+
+template<uint64_t N>
+class StaticByteStream<N>::Reader : public StaticByteStream<N>
+{
+public:
+  // 从读位置开始的最长连续可读区域（回绕时只返回回绕点之前的部分）
+  std::string_view peek() const
+  {
+    const uint64_t pos = this->slot( this->bytes_read_ );
+    return { this->buffer_ + pos, std::min( bytes_buffered(), N - pos ) };
+  }
+
+  // 按顺序放入所有连续可读区域（至多两段）
+  void peek_all( std::vector<std::string_view>& views ) const
+  {
+    views.clear();
+    const uint64_t pos = this->slot( this->bytes_read_ );
+    const uint64_t first = std::min( bytes_buffered(), N - pos );
+    if ( first > 0 ) {
+      views.emplace_back( this->buffer_ + pos, first );
+    }
+    if ( bytes_buffered() > first ) {
+      views.emplace_back( this->buffer_, bytes_buffered() - first );
+    }
+  }
+
+  void pop( uint64_t len ) { this->bytes_read_ += std::min( len, bytes_buffered() ); }
+
+  // 把开头最多 out.size() 个字节拷贝到 `out` 并弹出，返回拷贝的字节数
+  uint64_t read_into( std::span<char> out )
+  {
+    const uint64_t len = std::min( static_cast<uint64_t>( out.size() ), bytes_buffered() );
+    if ( len == 0 ) {
+      return 0;
+    }
+    const uint64_t pos = this->slot( this->bytes_read_ );
+    const uint64_t first = std::min( len, N - pos );
+    this->copy( out.data(), this->buffer_ + pos, first );
+    this->copy( out.data() + first, this->buffer_, len - first );
+    this->bytes_read_ += len;
+    return len;
+  }
+
+  bool is_finished() const { return this->closed_ && bytes_buffered() == 0; }
+  uint64_t bytes_buffered() const { return this->bytes_written_ - this->bytes_read_; }
+  uint64_t bytes_popped() const { return this->bytes_read_; }
+};
@@ -1,15 +1,317 @@
 #include "tcp_receiver.hh"
 
+#include <algorithm>
+#include <cstdint>
+
 using namespace std;
 
+TCPReceiver::TCPReceiver( Reassembler&& reassembler, const TCPConfig& config )
+  : reassembler_( move( reassembler ) )
+  , delayed_ack_( config.delayed_ack )
+  , ack_delay_timeout_( config.ack_delay_timeout )
+  , ack_every_bytes_( config.ack_every * TCPConfig::MAX_PAYLOAD_SIZE )
+  , capacity_max_( config.recv_capacity_max )
+  , idle_timeout_( config.recv_idle_timeout )
+{
+  if ( !config.window_scaling ) {
+    offered_shift_.reset();
+  } else if ( capacity_max_ > capacity_min_ ) {
+    // 缓冲区以后可能长到 capacity_max_，shift 在 SYN 里定下就不能再改
+    offered_shift_ = window_shift_for( capacity_max_ );
+  }
+}
+
 void TCPReceiver::receive( TCPSenderMessage message )
 {
-  // Your code here.
-  (void)message;
+  const uint64_t pushed = writer().bytes_pushed();
+  const uint64_t length = message.payload.size();
+
+  // 首部预测：连接已建立、没有任何控制位、序号正好是 ackno 的段（批量传输时几乎所有段都是这样）
+  // 就是流中紧接着的字节，不必 unwrap，也不用考虑 SYN/FIN 占的序号；Reassembler 里没有乱序字节时
+  // 直接追加到输出流
+  if ( fast_path_enabled_ && isn_ && !message.SYN && !message.FIN && !message.RST && !writer().is_closed()
+       && message.seqno == next_seqno() ) {
+    ++fast_path_.hits;
+    handshake_done_ = true;
+    if ( reassembler_.try_append( message.payload ) ) {
+      // 被窗口截断的段不算按序，要立即确认
+      note_segment( writer().bytes_pushed() - pushed == length, length );
+    } else {
+      // Reassembler 里有乱序字节，这个段在填洞
+      reassembler_.insert( pushed, move( message.payload ), false );
+      note_segment( false, length );
+    }
+    if ( capacity_max_ != 0 ) {
+      autotune( length != 0 );
+    }
+    return;
+  }
+  ++fast_path_.misses;
+
+  if ( message.RST ) {
+    reassembler_.reader().set_error();
+    return;
+  }
+  if ( message.SYN && !isn_ ) {
+    isn_ = message.seqno;
+    // 双方都提供了窗口缩放选项才启用，两个方向都是；超过 14 的 shift 按 14 处理
+    if ( message.window_scale && offered_shift_ ) {
+      peer_shift_ = min( *message.window_scale, TCPConfig::MAX_WINDOW_SHIFT );
+      window_shift_ = *offered_shift_;
+    }
+    // 本端是主动打开的一方：自己的 SYN 已经发出，收到的是 SYN-ACK，握手就此完成，下一个 ACK 就要缩放
+    handshake_done_ = syn_sent_;
+  }
+  if ( !isn_ ) {
+    // 还没建立连接，丢弃
+    return;
+  }
+  if ( !message.SYN ) {
+    handshake_done_ = true;
+  }
+
+  // 绝对序号 0 是 SYN，流下标 = 绝对序号 - 1；用已写入的字节数作 checkpoint
+  const uint64_t abs_seqno = message.seqno.unwrap( *isn_, writer().bytes_pushed() + 1 );
+  const uint64_t seq_length = length + ( message.SYN ? 1 : 0 ) + ( message.FIN ? 1 : 0 );
+  if ( !message.SYN && abs_seqno == 0 ) {
+    // 数据不可能占用 SYN 的序号
+    note_segment( false, seq_length );
+    return;
+  }
+  const bool had_pending = reassembler_.bytes_pending() != 0;
+  const uint64_t first_index = abs_seqno + ( message.SYN ? 1 : 0 ) - 1;
+  reassembler_.insert( first_index, move( message.payload ), message.FIN );
+  note_segment( !message.SYN && !message.FIN && !had_pending && reassembler_.bytes_pending() == 0
+                  && writer().bytes_pushed() - pushed == length,
+                seq_length );
+  if ( capacity_max_ != 0 ) {
+    autotune( length != 0 );
+  }
 }
 
 TCPReceiverMessage TCPReceiver::send() const
 {
-  // Your code here.
-  return {};
+  TCPReceiverMessage message;
+  if ( isn_ ) {
+    message.ackno = next_seqno();
+  }
+  message.window_shift = send_shift();
+  message.window_size = static_cast<uint16_t>( advertised_window() >> message.window_shift );
+  message.RST = writer().has_error();
+  return message;
+}
+
+optional<TCPReceiverMessage> TCPReceiver::maybe_send()
+{
+  switch ( ack_reason_ ) {
+    case AckReason::None:
+      if ( !window_update_due() ) {
+        return nullopt;
+      }
+      ++ack_stats_.window_updates;
+      break;
+    case AckReason::Delayed:
+      ++ack_stats_.delayed_acks;
+      break;
+    case AckReason::Coalesced:
+      ++ack_stats_.coalesced_acks;
+      break;
+    case AckReason::Immediate:
+      ++ack_stats_.immediate_acks;
+      break;
+  }
+  return send_ack();
+}
+
+TCPReceiverMessage TCPReceiver::send_ack()
+{
+  ack_reason_ = AckReason::None;
+  unacked_bytes_ = 0;
+  ack_timer_.reset();
+  const TCPReceiverMessage message = send();
+  // 还没收到对端的 SYN 时，这个 ACK 捎带在本端的 SYN 上；收到之后发出的第一个 ACK 要么捎带在
+  // 本端的 SYN-ACK 上（被动打开），要么握手已经完成（主动打开），总之之后的 ACK 都要缩放
+  if ( isn_ ) {
+    handshake_done_ = true;
+  } else {
+    syn_sent_ = true;
+  }
+  advertised_edge_ = writer().bytes_pushed() + message.window();
+  ++ack_stats_.acks_sent;
+  return message;
+}
+
+bool TCPReceiver::ack_due() const
+{
+  return ack_reason_ != AckReason::None || window_update_due();
+}
+
+void TCPReceiver::tick( uint64_t ms_since_last_tick )
+{
+  now_ += ms_since_last_tick;
+  if ( capacity_max_ != 0 ) {
+    adjust_capacity();
+  }
+  if ( !ack_timer_ ) {
+    return;
+  }
+  *ack_timer_ += ms_since_last_tick;
+  if ( *ack_timer_ >= ack_delay_timeout_ ) {
+    ack_reason_ = max( ack_reason_, AckReason::Delayed );
+  }
+}
+
+void TCPReceiver::note_segment( bool in_order, uint64_t bytes )
+{
+  if ( bytes == 0 ) {
+    // 不占序号的段（纯 ACK）不需要确认
+    return;
+  }
+  ++ack_stats_.segments;
+  if ( !delayed_ack_ || !in_order ) {
+    ack_reason_ = AckReason::Immediate;
+    return;
+  }
+  unacked_bytes_ += bytes;
+  if ( unacked_bytes_ >= ack_every_bytes_ ) {
+    ack_reason_ = max( ack_reason_, AckReason::Coalesced );
+  } else if ( !ack_timer_ ) {
+    ack_timer_ = 0;
+  }
+}
+
+bool TCPReceiver::window_update_due() const
+{
+  if ( !isn_ || writer().is_closed() ) {
+    return false;
+  }
+  // 右沿 = 已读字节数 + 容量，只在应用读走数据时前移。对端眼中的窗口还剩一半以上时不必单独通告；
+  // 否则新窗口要比它大一倍、且右沿至少前移 min(容量 / 2, 一个满长度段)（RFC 1122 4.2.3.3 的接收方 SWS 避免）
+  const uint64_t pushed = writer().bytes_pushed();
+  const uint64_t available = advertised_window();
+  uint64_t capacity = reader().bytes_buffered() + writer().available_capacity();
+  if ( shrinking_ ) {
+    capacity = min( capacity, window_clamp_ );
+  }
+  capacity = min<uint64_t>( capacity, static_cast<uint64_t>( UINT16_MAX ) << send_shift() );
+  const uint64_t seen = advertised_edge_ > pushed ? advertised_edge_ - pushed : 0;
+  const uint64_t threshold = max<uint64_t>( 1, min<uint64_t>( capacity / 2, TCPConfig::MAX_PAYLOAD_SIZE ) );
+  return seen * 2 <= capacity && available >= 2 * seen && pushed + available >= advertised_edge_ + threshold;
+}
+
+Wrap32 TCPReceiver::next_seqno() const
+{
+  return Wrap32::wrap( writer().bytes_pushed() + 1 + ( writer().is_closed() ? 1 : 0 ), *isn_ );
+}
+
+void TCPReceiver::autotune( bool got_data )
+{
+  if ( got_data ) {
+    last_data_time_ = now_;
+    measure_rtt();
+  }
+  adjust_capacity();
+}
+
+void TCPReceiver::measure_rtt()
+{
+  // 仿 Linux 的 tcp_rcv_rtt_measure：从开始测量时的窗口右沿算起，数据收到那里就过了大约一个 RTT
+  const uint64_t pushed = writer().bytes_pushed();
+  if ( rtt_edge_ ) {
+    if ( pushed < *rtt_edge_ ) {
+      return;
+    }
+    const uint64_t sample = now_ - rtt_start_;
+    if ( sample == 0 ) {
+      // 一个 tick 之内就收完了，测不出来，接着等
+      return;
+    }
+    autotune_.rtt_ms = autotune_.rtt_ms ? min( autotune_.rtt_ms, sample ) : sample;
+  }
+  rtt_edge_ = pushed + max<uint64_t>( advertised_window(), TCPConfig::MAX_PAYLOAD_SIZE );
+  rtt_start_ = now_;
+}
+
+void TCPReceiver::adjust_capacity()
+{
+  if ( writer().is_closed() ) {
+    return;
+  }
+  const bool idle = now_ - last_data_time_ >= idle_timeout_;
+  if ( idle && !shrinking_ && writer().capacity() > capacity_min_ ) {
+    // 空闲：开始缩回初始容量，重新开始统计
+    shrinking_ = true;
+    ++autotune_.shrinks;
+    space_ = 0;
+    rtt_edge_.reset();
+  }
+  if ( shrinking_ ) {
+    shrink();
+  }
+  if ( idle ) {
+    return;
+  }
+  const uint64_t capacity = writer().capacity();
+
+  if ( autotune_.rtt_ms == 0 || now_ - space_time_ < autotune_.rtt_ms ) {
+    return;
+  }
+  const uint64_t popped = reader().bytes_popped();
+  const uint64_t copied = popped - space_popped_;
+  space_popped_ = popped;
+  space_time_ = now_;
+  if ( copied <= space_ ) {
+    return;
+  }
+
+  uint64_t target = 2 * copied;
+  if ( space_ != 0 ) {
+    // 比上一个 RTT 多读了几成，就再多给几成（最多再翻一倍）
+    target += target * min( copied - space_, space_ ) / space_;
+  }
+  space_ = copied;
+  target = min( { target, capacity_max_, static_cast<uint64_t>( UINT16_MAX ) << window_shift_ } );
+  if ( target > capacity && reassembler_.set_capacity( target ) ) {
+    ++autotune_.grows;
+    shrinking_ = false;
+  }
+}
+
+void TCPReceiver::shrink()
+{
+  // 不能收回已经通告的窗口（RFC 9293 3.8.6.2.2）：通告的容量至少要让窗口（按 shift 向下取整之后）还够到上次通告的
+  // 右沿。右沿 = 已读字节数 + 容量，应用读走数据后容量跟着减，右沿不动，窗口随着对端的数据到达自然关上
+  const uint64_t pushed = writer().bytes_pushed();
+  const uint64_t unit = uint64_t { 1 } << send_shift();
+  const uint64_t promised = advertised_edge_ > pushed ? ( advertised_edge_ - pushed + unit - 1 ) / unit * unit : 0;
+  window_clamp_ = max( capacity_min_, reader().bytes_buffered() + promised );
+  // 换缓冲区要拷贝缓冲的字节，所以平时只压低通告的窗口，等能省下一半内存或者缩到底时才真的换；
+  // 保存着乱序字节时 Reassembler 可能拒绝，下次再试
+  if ( window_clamp_ <= max( capacity_min_, writer().capacity() / 2 ) ) {
+    reassembler_.set_capacity( window_clamp_ );
+  }
+  if ( writer().capacity() <= capacity_min_ ) {
+    shrinking_ = false;
+  }
+}
+
+uint8_t TCPReceiver::window_shift_for( uint64_t capacity )
+{
+  uint8_t shift = 0;
+  while ( shift < TCPConfig::MAX_WINDOW_SHIFT && ( capacity >> shift ) > UINT16_MAX ) {
+    ++shift;
+  }
+  return shift;
+}
+
+uint64_t TCPReceiver::advertised_window() const
+{
+  // 右移会向下取整，通告的窗口不会超过真实的剩余容量；缩小容量期间也不超过 window_clamp_ 剩下的部分
+  uint64_t available = writer().available_capacity();
+  if ( shrinking_ ) {
+    const uint64_t buffered = reader().bytes_buffered();
+    available = min( available, window_clamp_ > buffered ? window_clamp_ - buffered : 0 );
+  }
+  const uint8_t shift = send_shift();
+  return min<uint64_t>( available >> shift, UINT16_MAX ) << shift;
 }
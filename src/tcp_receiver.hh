@@ -1,14 +1,20 @@
 #pragma once
 
 #include "reassembler.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <optional>
+
 class TCPReceiver
 {
 public:
   // Construct with given Reassembler
   explicit TCPReceiver( Reassembler&& reassembler ) : reassembler_( std::move( reassembler ) ) {}
+  // 按 config 里的 delayed_ack/ack_delay_timeout/ack_every 设置 ACK 策略，window_scaling 决定是否提供窗口缩放，
+  // recv_capacity_max/recv_idle_timeout 设置接收缓冲区自动调整（初始容量就是 reassembler 输出流的容量）
+  TCPReceiver( Reassembler&& reassembler, const TCPConfig& config );
 
   /*
    * The TCPReceiver receives TCPSenderMessages, inserting their payload into the Reassembler
@@ -19,6 +25,78 @@ public:
   // The TCPReceiver sends TCPReceiverMessages to the peer's TCPSender.
   TCPReceiverMessage send() const;
 
+  /*
+   * ACK 策略（RFC 1122 4.2.3.2 / RFC 5681 4.2）：send() 随时都能生成 ACK，但每个段都确认会让批量传输的
+   * 包量翻倍。maybe_send() 只在该确认的时候返回 ACK：
+   *   - SYN、FIN、乱序、重复、填洞或超出窗口的段立即确认；
+   *   - 按序数据攒够 ack_every 个满长度段（MAX_PAYLOAD_SIZE 字节）后确认；
+   *   - 其余按序数据启动延迟 ACK 定时器，tick() 累计到 ack_delay_timeout 毫秒后确认；
+   *   - 对端看到的窗口不到容量一半、应用读走数据后窗口至少翻倍时发窗口更新。
+   * 关掉 delayed_ack 后每个占序号的段都立即确认。
+   */
+  std::optional<TCPReceiverMessage> maybe_send();
+  // 不管策略，立即生成 ACK（比如捎带在要发出的数据段上），并清掉待确认的状态
+  TCPReceiverMessage send_ack();
+  // 是否有 ACK 该发了
+  bool ack_due() const;
+  // 推进延迟 ACK 定时器和自动调整用的时钟
+  void tick( uint64_t ms_since_last_tick );
+
+  struct AckStats
+  {
+    uint64_t segments {};       // 收到的占序号的段，也就是每段都确认时要发的 ACK 数
+    uint64_t acks_sent {};      // maybe_send() 和 send_ack() 实际发出的 ACK
+    uint64_t immediate_acks {}; // 乱序、重复、SYN/FIN 等立即发出的
+    uint64_t coalesced_acks {}; // 攒够 ack_every 个满长度段后发出的
+    uint64_t delayed_acks {};   // 延迟 ACK 定时器到期后发出的
+    uint64_t window_updates {}; // 窗口变大后发出的
+    // 相比每段都确认省下的 ACK
+    uint64_t acks_saved() const { return segments > acks_sent ? segments - acks_sent : 0; }
+  };
+  const AckStats& ack_stats() const { return ack_stats_; }
+
+  /*
+   * 窗口缩放（RFC 7323）：窗口字段只有 16 位，容量超过 64 KB 时通告的是 window >> shift。
+   * 本端提出的 shift 是让容量装得进 16 位的最小值（至多 14），要放进本端发出的 SYN；
+   * 对端的 SYN 也带了窗口缩放选项时才生效，否则 shift 为 0，窗口照旧截到 UINT16_MAX。
+   * SYN 段上的窗口从不缩放，两个 SYN 都交换过之后的 ACK 才缩放。本端的 SYN 是否已经发出，靠发出的每个段
+   * （包括本端的 SYN 和 SYN-ACK）都经 send_ack() 或 maybe_send() 取 ACK 来判断：
+   *   - 主动打开：收到对端 SYN 之前就发过 ACK（捎带在本端的 SYN 上），收到 SYN-ACK 后马上开始缩放；
+   *   - 被动打开：收到 SYN 后的第一个 ACK 捎带在本端的 SYN-ACK 上，不缩放，之后的才缩放。
+   * 只用 send() 的调用者，收到对端第一个不带 SYN 的段时也认为握手完成。
+   */
+  std::optional<uint8_t> offered_window_shift() const { return offered_shift_; }
+  // 对端 SYN 里的 shift，用来换算对端通告的窗口；没有启用窗口缩放时为空
+  std::optional<uint8_t> peer_window_shift() const { return peer_shift_; }
+  // 协商好的 shift，握手完成后生效
+  uint8_t window_shift() const { return window_shift_; }
+
+  /*
+   * 接收缓冲区自动调整（仿 Linux 的 tcp_rcv_space_adjust）：每过一个 RTT，看应用这段时间读走了多少字节；
+   * 比上一个 RTT 多时，把输出流的容量调到它的两倍（一份在路上、一份等应用读），再按这一轮的增长比例多给一些，
+   * 跟上对端慢启动的翻倍，但不超过 recv_capacity_max（没有窗口缩放时也不超过 64 KB）。
+   * 连续 recv_idle_timeout 毫秒没收到数据时开始缩回初始容量，但不收回已经通告的窗口：右沿（已读字节数 + 容量）
+   * 不低于上次经 send_ack()/maybe_send() 通告的右沿，容量随应用读走数据逐步减小，直到回到初始容量。
+   * RTT 用收完一个窗口的数据所花的时间估计：对端受窗口限制时这差不多就是一个 RTT，否则偏大，所以取最小值。
+   */
+  struct AutotuneStats
+  {
+    uint64_t rtt_ms {};  // 估计的 RTT，还没测到时为 0
+    uint64_t grows {};   // 扩大容量的次数
+    uint64_t shrinks {}; // 空闲后开始缩小容量的次数
+  };
+  const AutotuneStats& autotune_stats() const { return autotune_; }
+
+  // 首部预测（header prediction）的命中情况：命中的段跳过 unwrap 和下标换算，直接按序交给 Reassembler
+  struct FastPathStats
+  {
+    uint64_t hits {};   // 不带 SYN/FIN/RST、序号正好等于 ackno 的段
+    uint64_t misses {}; // 其余走通用路径的段
+  };
+  FastPathStats fast_path_stats() const { return fast_path_; }
+  // 关掉后所有段都走通用路径（用于对比测试）
+  void set_fast_path( bool enabled ) { fast_path_enabled_ = enabled; }
+
   // Access the output (only Reader is accessible non-const)
   const Reassembler& reassembler() const { return reassembler_; }
   Reader& reader() { return reassembler_.reader(); }
@@ -27,4 +105,63 @@ public:
 
 private:
   Reassembler reassembler_;
+  std::optional<Wrap32> isn_ {}; // 收到 SYN 之前为空
+  std::optional<uint8_t> offered_shift_ { window_shift_for( writer().available_capacity() ) };
+  std::optional<uint8_t> peer_shift_ {};
+  uint8_t window_shift_ {};
+  bool syn_sent_ {};       // 收到对端 SYN 之前 send_ack() 发过 ACK，也就是本端的 SYN 已经发出
+  bool handshake_done_ {}; // 两个 SYN 都交换过了，窗口开始缩放
+  FastPathStats fast_path_ {};
+  bool fast_path_enabled_ { true };
+
+  // 待发 ACK 的原因，数值越大越紧急
+  enum class AckReason : uint8_t
+  {
+    None,
+    Delayed,
+    Coalesced,
+    Immediate,
+  };
+  bool delayed_ack_ { true };
+  uint64_t ack_delay_timeout_ { TCPConfig::ACK_DELAY_DFLT };
+  uint64_t ack_every_bytes_ { 2 * TCPConfig::MAX_PAYLOAD_SIZE };
+  AckReason ack_reason_ { AckReason::None };
+  uint64_t unacked_bytes_ {};            // 上次确认之后按序收到的字节
+  std::optional<uint64_t> ack_timer_ {}; // 延迟 ACK 定时器走过的毫秒数，没启动时为空
+  uint64_t advertised_edge_ {};          // 上次确认通告的窗口右沿（流下标）
+  AckStats ack_stats_ {};
+
+  // 接收缓冲区自动调整，capacity_max_ 为 0 时关闭
+  uint64_t capacity_min_ { writer().capacity() };
+  uint64_t capacity_max_ {};
+  uint64_t idle_timeout_ { TCPConfig::RECV_IDLE_DFLT };
+  uint64_t now_ {};                     // tick() 累计的毫秒数
+  uint64_t last_data_time_ {};          // 最近一次收到数据的时间
+  std::optional<uint64_t> rtt_edge_ {}; // 正在进行的 RTT 测量在收到这个流下标时结束
+  uint64_t rtt_start_ {};
+  uint64_t space_ {};        // 上一个 RTT 应用读走的字节数
+  uint64_t space_popped_ {}; // 这一轮统计开始时已读的字节数
+  uint64_t space_time_ {};   // 这一轮统计开始的时间
+  bool shrinking_ {};        // 空闲之后正在缩回初始容量
+  uint64_t window_clamp_ {}; // 缩小期间通告窗口时按这个容量算，输出流的容量稍后才跟上
+  AutotuneStats autotune_ {};
+  // 收到一个段之后：有数据就更新空闲时间和 RTT 估计，再看要不要调整容量
+  void autotune( bool got_data );
+  void measure_rtt();
+  void adjust_capacity();
+  // 在不收回已通告窗口的前提下，把通告的容量尽量压向初始容量，能省下一半内存时才真的缩小输出流
+  void shrink();
+
+  // 记下一个段对 ACK 的要求；in_order 表示它的数据全部按序写入了输出流
+  void note_segment( bool in_order, uint64_t bytes );
+  bool window_update_due() const;
+
+  // 下一个期望收到的序号：SYN 占一个序号，流关闭后 FIN 也占一个
+  Wrap32 next_seqno() const;
+  // 能装下 capacity 的最小 shift
+  static uint8_t window_shift_for( uint64_t capacity );
+  // send() 用的 shift：握手完成前为 0
+  uint8_t send_shift() const { return handshake_done_ ? window_shift_ : 0; }
+  // 按 send_shift() 实际能通告的窗口（字节）
+  uint64_t advertised_window() const;
 };
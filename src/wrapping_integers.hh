@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
 /*
  * The Wrap32 type represents a 32-bit unsigned integer that:
@@ -11,10 +12,14 @@
 class Wrap32
 {
 public:
-  explicit Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
+  explicit constexpr Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
 
   /* Construct a Wrap32 given an absolute sequence number n and the zero point. */
-  static Wrap32 wrap( uint64_t n, Wrap32 zero_point );
+  static constexpr Wrap32 wrap( uint64_t n, Wrap32 zero_point )
+  {
+    // 只保留低 32 位，加法自然回绕
+    return zero_point + static_cast<uint32_t>( n );
+  }
 
   /*
    * The unwrap method returns an absolute sequence number that wraps to this Wrap32, given the zero point
@@ -22,11 +27,51 @@ public:
    *
    * There are many possible absolute sequence numbers that all wrap to the same Wrap32.
    * The unwrap method should return the one that is closest to the checkpoint.
+   *
+   * Branch-free and constexpr (see tests/wrapping_integers_constexpr.cc). A tie, 2^31 away on either side,
+   * goes to the smaller one unless that would be negative; nothing wraps past 0 or 2^64.
+   */
+  constexpr uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const
+  {
+    // 本序号相对 wrap(checkpoint) 的距离，看成有符号数就是离 checkpoint 最近的那个方向
+    const uint32_t offset = raw_value_ - zero_point.raw_value_ - static_cast<uint32_t>( checkpoint );
+    const auto distance = static_cast<int64_t>( static_cast<int32_t>( offset ) );
+    const auto step = static_cast<uint64_t>( distance );
+    const uint64_t nearest = checkpoint + step;
+    // 加上负的距离却没有进位，说明往回越过了 0，改取往后的那个；加上正的距离却有进位，说明越过了 2^64，改取往前的那个。
+    // 进位用位运算求（不用 64 位比较，SSE2 没有），批量版本才能向量化
+    const uint64_t carry = ( ( checkpoint & step ) | ( ( checkpoint | step ) & ~nearest ) ) >> 63;
+    const uint64_t negative = offset >> 31;
+    const uint64_t underflow = negative & ( carry ^ 1 );
+    const uint64_t overflow = ( negative ^ 1 ) & carry;
+    return nearest + ( underflow << 32 ) - ( overflow << 32 );
+  }
+
+  /*
+   * Unwrap every seqno in `seqnos` against the same zero point and checkpoint (e.g. a batch of segments read
+   * in one system call) into the same position of `out`. The loop body is the branch-free unwrap above, so
+   * the compiler can vectorize it.
    */
-  uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const;
+  static void unwrap( std::span<const Wrap32> seqnos,
+                      Wrap32 zero_point,
+                      uint64_t checkpoint,
+                      std::span<uint64_t> out );
 
-  Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
-  bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
+  constexpr Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
+  constexpr bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
+
+  /*
+   * Serial number arithmetic (RFC 1982): a < b iff b is less than 2^31 ahead of a, going around the wrap.
+   * Two values exactly 2^31 apart are not ordered either way, so these are not a total order.
+   */
+  constexpr bool operator<( const Wrap32& other ) const
+  {
+    // other 领先 1 ~ 2^31 - 1 时才更大
+    return other.raw_value_ - raw_value_ - 1U < static_cast<uint32_t>( INT32_MAX );
+  }
+  constexpr bool operator>( const Wrap32& other ) const { return other < *this; }
+  constexpr bool operator<=( const Wrap32& other ) const { return *this == other || *this < other; }
+  constexpr bool operator>=( const Wrap32& other ) const { return *this == other || other < *this; }
 
 protected:
   uint32_t raw_value_ {};
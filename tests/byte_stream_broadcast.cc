@@ -0,0 +1,117 @@
+#include "broadcast_byte_stream.hh"
+#include "byte_stream.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+void basic_test()
+{
+  BroadcastByteStream bs { 4, 3 };
+
+  bs.writer().push( "abcdef" );
+  if ( bs.writer().bytes_pushed() != 4 or bs.writer().available_capacity() != 0 ) {
+    throw runtime_error( "BroadcastByteStream did not truncate a push to its capacity" );
+  }
+  for ( size_t i = 0; i < bs.num_readers(); ++i ) {
+    if ( bs.reader( i ).peek() != "abcd" ) {
+      throw runtime_error( "BroadcastByteStream reader " + to_string( i ) + " did not see the pushed bytes" );
+    }
+  }
+
+  bs.reader( 0 ).pop( 3 );
+  bs.reader( 1 ).pop( 2 );
+  if ( bs.writer().available_capacity() != 0 ) {
+    throw runtime_error( "BroadcastByteStream reclaimed space that the slowest reader has not popped" );
+  }
+  bs.reader( 2 ).pop( 1 );
+  if ( bs.writer().available_capacity() != 1 ) {
+    throw runtime_error( "BroadcastByteStream available_capacity() did not follow the slowest reader" );
+  }
+  bs.reader( 2 ).pop( 3 );
+  if ( bs.writer().available_capacity() != 2 ) {
+    throw runtime_error( "BroadcastByteStream did not hand the slowest reader's space to the next slowest" );
+  }
+
+  bs.writer().push( "efgh" );
+  if ( bs.reader( 0 ).peek() != "d" or bs.reader( 1 ).peek() != "cd" or bs.reader( 2 ).peek() != "ef" ) {
+    throw runtime_error( "BroadcastByteStream readers did not keep independent cursors across the wrap point" );
+  }
+  vector<string_view> views;
+  bs.reader( 1 ).peek_all( views );
+  if ( views.size() != 2 or views[0] != "cd" or views[1] != "ef" ) {
+    throw runtime_error( "BroadcastByteStream peek_all() did not return both ring segments" );
+  }
+
+  bs.writer().close();
+  string out( 8, 0 );
+  out.resize( bs.reader( 0 ).read_into( out ) );
+  if ( out != "def" or not bs.reader( 0 ).is_finished() or bs.reader( 1 ).is_finished() ) {
+    throw runtime_error( "BroadcastByteStream read_into() or is_finished() misbehaved" );
+  }
+  bs.writer().push( "x" );
+  if ( not bs.has_error() ) {
+    throw runtime_error( "BroadcastByteStream push() after close() did not set error" );
+  }
+}
+
+// Every reader must see exactly the bytes a private ByteStream would have seen, whatever order they pop in.
+void random_test( const size_t capacity, const size_t num_readers, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<size_t> op_size { 0, capacity + 2 };
+  uniform_int_distribution<size_t> pick { 0, num_readers };
+
+  BroadcastByteStream bs { capacity, num_readers };
+  string sent;
+  vector<string> received( num_readers );
+  for ( size_t i = 0; i < 20000; ++i ) {
+    const size_t who = pick( rd );
+    if ( who == num_readers ) {
+      const string data = random_bytes( op_size( rd ), rd() );
+      const uint64_t before = bs.writer().bytes_pushed();
+      bs.writer().push( data );
+      sent += data.substr( 0, bs.writer().bytes_pushed() - before );
+    } else {
+      string out( op_size( rd ), 0 );
+      out.resize( bs.reader( who ).read_into( out ) );
+      received[who] += out;
+    }
+
+    uint64_t slowest = sent.size();
+    for ( size_t r = 0; r < num_readers; ++r ) {
+      slowest = min<uint64_t>( slowest, received[r].size() );
+    }
+    if ( bs.writer().available_capacity() != capacity - ( sent.size() - slowest ) ) {
+      throw runtime_error( "BroadcastByteStream available_capacity() does not match the slowest reader" );
+    }
+  }
+
+  for ( size_t r = 0; r < num_readers; ++r ) {
+    string rest( bs.reader( r ).bytes_buffered(), 0 );
+    bs.reader( r ).read_into( rest );
+    if ( received[r] + rest != sent ) {
+      throw runtime_error( "BroadcastByteStream reader " + to_string( r ) + " saw different bytes" );
+    }
+  }
+}
+
+int main()
+{
+  try {
+    basic_test();
+    random_test( 16, 1, 1 );
+    random_test( 17, 3, 2 );
+    random_test( 1500, 5, 3 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
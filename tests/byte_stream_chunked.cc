@@ -0,0 +1,72 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "chunked peek-per-chunk", 15, ByteStream::Storage::Chunked };
+
+      test.execute( Push { "cat" } );
+      test.execute( Push { "tac" } );
+      test.execute( BytesPushed { 6 } );
+      test.execute( AvailableCapacity { 9 } );
+      test.execute( PeekOnce { "cat" } );
+      test.execute( Peek { "cattac" } );
+
+      test.execute( Pop { 1 } );
+      test.execute( PeekOnce { "at" } );
+
+      test.execute( Pop { 3 } );
+      test.execute( PeekOnce { "ac" } );
+      test.execute( BytesPopped { 4 } );
+      test.execute( BytesBuffered { 2 } );
+      test.execute( AvailableCapacity { 13 } );
+
+      test.execute( Close {} );
+      test.execute( Pop { 2 } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunked truncate", 5, ByteStream::Storage::Chunked };
+
+      test.execute( Push { "abc" } );
+      test.execute( Push { "defgh" } );
+      test.execute( BytesPushed { 5 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Push { "ijk" } );
+      test.execute( BytesPushed { 5 } );
+      test.execute( Peek { "abcde" } );
+
+      test.execute( Pop { 4 } );
+      test.execute( PeekOnce { "e" } );
+      test.execute( Push { "xyz" } );
+      test.execute( Peek { "exyz" } );
+      test.execute( ReadAll { "exyz" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunked empty pushes", 3, ByteStream::Storage::Chunked };
+
+      test.execute( Push { "" } );
+      test.execute( BufferEmpty { true } );
+      test.execute( PeekOnce { "" } );
+      test.execute( Push { "ab" } );
+      test.execute( Push { "" } );
+      test.execute( Pop { 5 } );
+      test.execute( BytesPopped { 2 } );
+      test.execute( BufferEmpty { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
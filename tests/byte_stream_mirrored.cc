@@ -0,0 +1,59 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <unistd.h>
+
+using namespace std;
+
+int main()
+{
+  try {
+    const auto page = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+
+    {
+      ByteStreamTestHarness test { "mirrored wraparound", page, ByteStream::Storage::Mirrored };
+
+      test.execute( Push { string( page - 2, 'x' ) } );
+      test.execute( Pop { page - 3 } );
+      test.execute( Push { "abcdef" } );
+      test.execute( BytesBuffered { 7 } );
+      test.execute( PeekOnce { "xabcdef" } );
+      test.execute( PeekAll { { "xabcdef" } } );
+
+      test.execute( Pop { 3 } );
+      test.execute( PeekOnce { "cdef" } );
+      test.execute( ReserveCommit { 3, "ghi" } );
+      test.execute( PeekOnce { "cdefghi" } );
+      test.execute( Close {} );
+      test.execute( ReadAll { "cdefghi" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "mirrored full ring", page, ByteStream::Storage::Mirrored };
+
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { string( page, 'y' ) } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( PeekOnce { string( page, 'y' ) } );
+    }
+
+    {
+      ByteStreamTestHarness test { "mirrored falls back to ring", 4, ByteStream::Storage::Mirrored };
+
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 2 } );
+      test.execute( Push { "def" } );
+      test.execute( PeekAll { { "cd", "ef" } } );
+      test.execute( Peek { "cdef" } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    constexpr size_t page = PagePool::kPageSize;
+
+    {
+      ByteStreamTestHarness test { "paged grows and shrinks", 3 * page, ByteStream::Storage::Paged };
+
+      test.execute( MemoryUsage { 0 } );
+      test.execute( Push { "hello" } );
+      test.execute( MemoryUsage { page } );
+      test.execute( PeekOnce { "hello" } );
+
+      test.execute( Push { string( page, 'x' ) } );
+      test.execute( MemoryUsage { 2 * page } );
+      test.execute( BytesBuffered { page + 5 } );
+      test.execute( PeekOnce { "hello" + string( page - 5, 'x' ) } );
+      test.execute( PeekAll { { "hello" + string( page - 5, 'x' ), "xxxxx" } } );
+
+      test.execute( Pop { page } );
+      test.execute( MemoryUsage { page } );
+      test.execute( PeekOnce { "xxxxx" } );
+
+      test.execute( Pop { 5 } );
+      test.execute( BufferEmpty { true } );
+      test.execute( MemoryUsage { 0 } );
+
+      test.execute( Push { "abc" } );
+      test.execute( MemoryUsage { page } );
+      test.execute( Peek { "abc" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "paged capacity", 10, ByteStream::Storage::Paged };
+
+      test.execute( Push { "abcdefghijkl" } );
+      test.execute( BytesPushed { 10 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( MemoryUsage { page } );
+      test.execute( ReadAll { "abcdefghij" } );
+      test.execute( MemoryUsage { 0 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "paged reserve-commit", 3 * page, ByteStream::Storage::Paged };
+
+      test.execute( Push { string( page - 2, 'y' ) } );
+      test.execute( ReserveCommit { page, "abcd" } );
+      test.execute( MemoryUsage { 2 * page } );
+      test.execute( PeekAll { { string( page - 2, 'y' ) + "ab", "cd" } } );
+      test.execute( ReserveCommit { 2 * page, "" } );
+      test.execute( MemoryUsage { 2 * page } );
+      test.execute( Pop { page } );
+      test.execute( MemoryUsage { page } );
+      test.execute( Peek { "cd" } );
+    }
+
+    {
+      // Once a burst drains, the stream holds no memory and the pool keeps at most max_cached() of its pages
+      PagePool& pool = PagePool::global();
+      const size_t old_max_cached = pool.max_cached();
+      const size_t in_use = pool.pages_in_use();
+      pool.set_max_cached( 16 );
+
+      ByteStream bs { 256 * page, ByteStream::Storage::Paged };
+      bs.writer().push( string( 256 * page, 'z' ) );
+      check( bs.memory_usage() == 256 * page, "burst did not map a page per 4 KiB buffered" );
+      check( pool.pages_in_use() == in_use + 256, "pool did not count the burst's pages" );
+
+      string out;
+      read( bs.reader(), out );
+      check( out == string( 256 * page, 'z' ), "burst read back the wrong bytes" );
+      check( bs.memory_usage() == 0, "drained stream still holds pages" );
+      check( pool.pages_in_use() == in_use, "drained stream's pages are still counted in use" );
+      check( pool.pages_cached() == 16, "pool did not keep exactly max_cached() pages after the burst" );
+
+      pool.set_max_cached( 4 );
+      check( pool.pages_cached() == 4, "lowering max_cached() did not release the extra pages" );
+      pool.set_max_cached( old_max_cached );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
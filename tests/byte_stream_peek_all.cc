@@ -0,0 +1,56 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "peek_all empty", 4 };
+
+      test.execute( PeekAll { {} } );
+      test.execute( Push { "ab" } );
+      test.execute( PeekAll { { "ab" } } );
+      test.execute( Pop { 2 } );
+      test.execute( PeekAll { {} } );
+    }
+
+    {
+      ByteStreamTestHarness test { "peek_all ring wraparound", 4 };
+
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "defg" } );
+      test.execute( PeekOnce { "d" } );
+      test.execute( PeekAll { { "d", "efg" } } );
+
+      test.execute( Pop { 2 } );
+      test.execute( PeekAll { { "fg" } } );
+      test.execute( Push { "hi" } );
+      test.execute( PeekAll { { "fgh", "i" } } );
+    }
+
+    {
+      ByteStreamTestHarness test { "peek_all chunked", 10, ByteStream::Storage::Chunked };
+
+      test.execute( Push { "ab" } );
+      test.execute( Push { "cde" } );
+      test.execute( Push { "f" } );
+      test.execute( PeekAll { { "ab", "cde", "f" } } );
+
+      test.execute( Pop { 3 } );
+      test.execute( PeekAll { { "de", "f" } } );
+      test.execute( Push { "ghijklmn" } );
+      test.execute( PeekAll { { "de", "f", "ghijklm" } } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
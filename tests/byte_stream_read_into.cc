@@ -0,0 +1,64 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "read_into across the wrap point", 5 };
+
+      test.execute( Push { "abcd" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "efgh" } );
+      test.execute( ReadInto { 3, "def" } );
+      test.execute( BytesPopped { 6 } );
+      test.execute( ReadInto { 10, "gh" } );
+      test.execute( BufferEmpty { true } );
+      test.execute( ReadInto { 10, "" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "read_into chunked", 10, ByteStream::Storage::Chunked };
+
+      test.execute( Push { "ab" } );
+      test.execute( Push { "cde" } );
+      test.execute( Push { "fg" } );
+      test.execute( ReadInto { 4, "abcd" } );
+      test.execute( PeekOnce { "e" } );
+      test.execute( ReadInto { 4, "efg" } );
+      test.execute( BytesPopped { 7 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "read appends", 8 };
+
+      test.execute( Push { "xyz" } );
+      test.execute( ReadAppend { "abc", "abcxyz" } );
+      test.execute( BufferEmpty { true } );
+      test.execute( Push { "1234" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "5678" } );
+      test.execute( ReadAppend { "", "45678" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "external storage holds no bytes", 8, ByteStream::Storage::External };
+
+      test.execute( Push { "abc" } );
+      test.execute( HasError { true } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( PeekAll { {} } );
+      test.execute( MemoryUsage { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
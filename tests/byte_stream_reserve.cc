@@ -0,0 +1,66 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "reserve-commit", 6 };
+
+      test.execute( ReserveSize { 10, 6 } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( ReserveCommit { 4, "cat" } );
+      test.execute( BytesPushed { 3 } );
+      test.execute( AvailableCapacity { 3 } );
+      test.execute( Peek { "cat" } );
+
+      test.execute( ReserveCommit { 10, "tacos" } );
+      test.execute( BytesPushed { 6 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( ReserveSize { 1, 0 } );
+      test.execute( Peek { "cattac" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "reserve-commit wraparound", 5 };
+
+      test.execute( Push { "abcd" } );
+      test.execute( Pop { 3 } );
+      test.execute( ReserveCommit { 4, "efgh" } );
+      test.execute( BytesPushed { 8 } );
+      test.execute( PeekAll { { "de", "fgh" } } );
+      test.execute( Peek { "defgh" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "reserve-commit chunked", 8, ByteStream::Storage::Chunked };
+
+      test.execute( Push { "ab" } );
+      test.execute( ReserveCommit { 4, "cde" } );
+      test.execute( ReserveCommit { 4, "" } );
+      test.execute( PeekAll { { "ab", "cde" } } );
+      test.execute( AvailableCapacity { 3 } );
+      test.execute( ReserveCommit { 9, "fghij" } );
+      test.execute( Peek { "abcdefgh" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "commit after close", 4 };
+
+      test.execute( Close {} );
+      test.execute( ReserveCommit { 2, "ab" } );
+      test.execute( HasError { true } );
+      test.execute( BytesPushed { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
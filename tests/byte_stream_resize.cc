@@ -0,0 +1,92 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+using namespace std;
+
+int main()
+{
+  try {
+    for ( const auto storage : { ByteStream::Storage::Ring,
+                                 ByteStream::Storage::Chunked,
+                                 ByteStream::Storage::Mirrored,
+                                 ByteStream::Storage::Paged } ) {
+      {
+        // Buffered bytes that wrap around the ring keep their order in the larger buffer
+        ByteStreamTestHarness test { "grow with wrapped bytes", 8, storage };
+
+        test.execute( Push { "abcdef" } );
+        test.execute( Pop { 4 } );
+        test.execute( Push { "ghijkl" } );
+        test.execute( AvailableCapacity { 0 } );
+        test.execute( SetCapacity { 20 } );
+        test.execute( AvailableCapacity { 12 } );
+        test.execute( BytesBuffered { 8 } );
+        test.execute( Push { "mnopqrstuvwxyz" } );
+        test.execute( BytesPushed { 24 } );
+        test.execute( ReadAll { "efghijklmnopqrstuvwx" } );
+        test.execute( Push { "0123" } );
+        test.execute( ReadAll { "0123" } );
+      }
+
+      {
+        // Shrinking never drops buffered bytes
+        ByteStreamTestHarness test { "shrink below buffered bytes", 16, storage };
+
+        test.execute( Push { "abcdefghij" } );
+        test.execute( Pop { 3 } );
+        test.execute( SetCapacity { 4 } );
+        test.execute( AvailableCapacity { 0 } );
+        test.execute( Pop { 5 } );
+        test.execute( AvailableCapacity { 5 } );
+        test.execute( Push { "klmnopq" } );
+        test.execute( ReadAll { "ijklmno" } );
+        test.execute( SetCapacity { 2 } );
+        test.execute( Push { "xyz" } );
+        test.execute( ReadAll { "xy" } );
+      }
+
+      {
+        // A closed stream can still be resized while the reader drains it
+        ByteStreamTestHarness test { "resize after close", 6, storage };
+
+        test.execute( Push { "abcdef" } );
+        test.execute( Close {} );
+        test.execute( SetCapacity { 12 } );
+        test.execute( IsClosed { true } );
+        test.execute( HasError { false } );
+        test.execute( ReadAll { "abcdef" } );
+        test.execute( IsFinished { true } );
+      }
+    }
+
+    {
+      // Mirrored storage stays mirrored at page multiples and falls back to Ring otherwise
+      const auto page = static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) );
+      ByteStream stream { page, ByteStream::Storage::Mirrored };
+      stream.writer().push( string( page - 10, 'a' ) );
+      stream.reader().pop( page - 20 );
+      stream.writer().set_capacity( 4 * page );
+      stream.writer().push( "bcd" );
+      string out;
+      read( stream.reader(), out );
+      if ( out != string( 10, 'a' ) + "bcd" or stream.capacity() != 4 * page ) {
+        throw runtime_error( "wrong bytes after growing a mirrored buffer" );
+      }
+      stream.writer().set_capacity( page + 1 );
+      if ( stream.storage() != ByteStream::Storage::Ring or stream.memory_usage() != page + 1 ) {
+        throw runtime_error( "mirrored buffer did not fall back to Ring" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
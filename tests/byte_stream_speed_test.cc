@@ -7,6 +7,7 @@
 #include <iostream>
 #include <queue>
 #include <random>
+#include <span>
 
 using namespace std;
 using namespace std::chrono;
@@ -35,8 +36,8 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
   }
 
   ByteStream bs { capacity };
-  string output_data;
-  output_data.reserve( data.size() );
+  string output_data( data.size(), 0 );
+  size_t output_len = 0;
 
   const auto start_time = steady_clock::now();
   while ( not bs.reader().is_finished() ) {
@@ -52,18 +53,18 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
     }
 
     if ( bs.reader().bytes_buffered() ) {
-      auto peeked = bs.reader().peek().substr( 0, read_size );
-      if ( peeked.empty() ) {
-        throw runtime_error( "ByteStream::reader().peek() returned empty view" );
+      const auto out = span { output_data }.subspan( output_len, min( read_size, data.size() - output_len ) );
+      const auto len = bs.reader().read_into( out );
+      if ( len == 0 ) {
+        throw runtime_error( "ByteStream::reader().read_into() read nothing from a non-empty stream" );
       }
-      output_data += peeked;
-      bs.reader().pop( peeked.size() );
+      output_len += len;
     }
   }
 
   const auto stop_time = steady_clock::now();
 
-  if ( data != output_data ) {
+  if ( output_len != data.size() or data != output_data ) {
     throw runtime_error( "Mismatch between data written and read" );
   }
 
@@ -0,0 +1,92 @@
+#include "spsc_byte_stream.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+void single_thread_test()
+{
+  SPSCByteStream bs { 4 };
+
+  bs.writer().push( "abc" );
+  if ( bs.reader().bytes_buffered() != 3 or bs.writer().available_capacity() != 1 ) {
+    throw runtime_error( "SPSCByteStream miscounted a push" );
+  }
+  bs.reader().pop( 2 );
+  bs.writer().push( "defg" );
+  if ( bs.writer().bytes_pushed() != 6 or bs.reader().peek() != "cd" ) {
+    throw runtime_error( "SPSCByteStream did not truncate or wrap correctly" );
+  }
+  bs.reader().pop( 2 );
+  if ( bs.reader().peek() != "ef" ) {
+    throw runtime_error( "SPSCByteStream peek() did not continue after the wrap point" );
+  }
+  bs.writer().close();
+  if ( bs.reader().is_finished() ) {
+    throw runtime_error( "SPSCByteStream finished with bytes still buffered" );
+  }
+  bs.reader().pop( 10 );
+  if ( not bs.reader().is_finished() or bs.reader().bytes_popped() != 6 ) {
+    throw runtime_error( "SPSCByteStream did not finish after the last pop" );
+  }
+  bs.writer().push( "x" );
+  if ( not bs.has_error() ) {
+    throw runtime_error( "SPSCByteStream push() after close() did not set error" );
+  }
+}
+
+void two_thread_test( const size_t input_len, // NOLINT(bugprone-easily-swappable-parameters)
+                      const size_t capacity,  // NOLINT(bugprone-easily-swappable-parameters)
+                      const size_t random_seed )
+{
+  const string data = random_bytes( input_len, random_seed );
+
+  SPSCByteStream bs { capacity, true };
+
+  thread producer { [&] {
+    default_random_engine rd { random_seed + 1 };
+    uniform_int_distribution<size_t> write_size { 1, capacity * 2 };
+    size_t pushed = 0;
+    while ( pushed < data.size() ) {
+      bs.writer().wait_writable();
+      bs.writer().push( data.substr( pushed, write_size( rd ) ) );
+      pushed = bs.writer().bytes_pushed();
+    }
+    bs.writer().close();
+  } };
+
+  string output;
+  while ( true ) {
+    bs.reader().wait_readable();
+    if ( bs.reader().is_finished() ) {
+      break;
+    }
+    const auto peeked = bs.reader().peek();
+    output += peeked;
+    bs.reader().pop( peeked.size() );
+  }
+  producer.join();
+
+  if ( output != data ) {
+    throw runtime_error( "Mismatch between data written and read across threads" );
+  }
+}
+
+int main()
+{
+  try {
+    single_thread_test();
+    two_thread_test( 100000, 7, 4321 );
+    two_thread_test( 1000000, 4096, 1234 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+#include "byte_stream.hh"
+#include "spsc_byte_stream.hh"
+#include "test_utils.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+double gigabits_per_second( const size_t len, const steady_clock::time_point start )
+{
+  auto test_duration = duration_cast<duration<double>>( steady_clock::now() - start );
+  return 8 * static_cast<double>( len ) / test_duration.count() / 1e9;
+}
+
+// The baseline: an ordinary ByteStream shared between threads behind one mutex. Each side yields after its
+// turn so the comparison stays fair when both threads share a core.
+double mutex_test( const string& data, const size_t capacity, const size_t write_size )
+{
+  ByteStream bs { capacity };
+  mutex lock;
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+  thread producer { [&] {
+    size_t pushed = 0;
+    while ( pushed < data.size() ) {
+      {
+        const lock_guard guard { lock };
+        bs.writer().push( data.substr( pushed, min( write_size, bs.writer().available_capacity() ) ) );
+        pushed = bs.writer().bytes_pushed();
+      }
+      this_thread::yield();
+    }
+    const lock_guard guard { lock };
+    bs.writer().close();
+  } };
+
+  while ( true ) {
+    {
+      const lock_guard guard { lock };
+      if ( bs.reader().is_finished() ) {
+        break;
+      }
+      const auto peeked = bs.reader().peek();
+      output_data += peeked;
+      bs.reader().pop( peeked.size() );
+    }
+    this_thread::yield();
+  }
+  producer.join();
+  const double result = gigabits_per_second( data.size(), start_time );
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read (mutex)" );
+  }
+  return result;
+}
+
+// Without wakeups, each side spins (yielding) until the other makes progress.
+double spsc_test( const string& data, const size_t capacity, const size_t write_size, const bool wakeups )
+{
+  SPSCByteStream bs { capacity, wakeups };
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+  thread producer { [&] {
+    size_t pushed = 0;
+    while ( pushed < data.size() ) {
+      if ( wakeups ) {
+        bs.writer().wait_writable();
+      } else if ( bs.writer().available_capacity() == 0 ) {
+        this_thread::yield();
+        continue;
+      }
+      bs.writer().push( data.substr( pushed, min( write_size, bs.writer().available_capacity() ) ) );
+      pushed = bs.writer().bytes_pushed();
+    }
+    bs.writer().close();
+  } };
+
+  while ( true ) {
+    if ( wakeups ) {
+      bs.reader().wait_readable();
+    } else if ( bs.reader().bytes_buffered() == 0 and not bs.reader().is_finished() ) {
+      this_thread::yield();
+      continue;
+    }
+    if ( bs.reader().is_finished() ) {
+      break;
+    }
+    const auto peeked = bs.reader().peek();
+    output_data += peeked;
+    bs.reader().pop( peeked.size() );
+  }
+  producer.join();
+  const double result = gigabits_per_second( data.size(), start_time );
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read (SPSC)" );
+  }
+  return result;
+}
+
+} // namespace
+
+void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t write_size ) // NOLINT(bugprone-easily-swappable-parameters)
+{
+  const string data = random_bytes( input_len, random_seed );
+
+  const double mutex_gbps = mutex_test( data, capacity, write_size );
+  const double spin_gbps = spsc_test( data, capacity, write_size, false );
+  const double futex_gbps = spsc_test( data, capacity, write_size, true );
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Two-thread ByteStream with capacity=" << capacity << ", write_size=" << write_size << ": " << fixed
+       << setprecision( 2 ) << "mutex " << mutex_gbps << " Gbit/s, SPSC (spinning) " << spin_gbps
+       << " Gbit/s, SPSC (futex wakeups) " << futex_gbps << " Gbit/s.\n";
+
+  debug_output << "       SPSC ByteStream throughput: " << fixed << setprecision( 2 ) << spin_gbps
+               << " Gbit/s (spinning), " << futex_gbps << " Gbit/s (futex), " << mutex_gbps
+               << " Gbit/s (mutex)\n";
+
+  if ( spin_gbps < 0.1 or futex_gbps < 0.1 ) {
+    throw runtime_error( "SPSCByteStream did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+void program_body()
+{
+  speed_test( 1e8, 32768, 789, 1500 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
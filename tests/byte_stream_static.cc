@@ -0,0 +1,93 @@
+#include "byte_stream.hh"
+#include "static_byte_stream.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// The same script as the SPSC single-thread test, run at a power-of-two and a non-power-of-two capacity.
+template<uint64_t N>
+void basic_test()
+{
+  static_assert( N >= 4 and N < 8 );
+  StaticByteStream<N> bs;
+
+  bs.writer().push( "abc" );
+  if ( bs.reader().bytes_buffered() != 3 or bs.writer().available_capacity() != N - 3 ) {
+    throw runtime_error( "StaticByteStream miscounted a push" );
+  }
+  bs.reader().pop( 2 );
+  bs.writer().push( string( "defghijk" ) );
+  if ( bs.writer().bytes_pushed() != N + 2 or bs.writer().available_capacity() != 0 ) {
+    throw runtime_error( "StaticByteStream did not truncate a push to the available capacity" );
+  }
+  string out( 3, 0 );
+  if ( bs.reader().read_into( out ) != 3 or out != "cde" ) {
+    throw runtime_error( "StaticByteStream read_into() returned the wrong bytes" );
+  }
+  vector<string_view> views;
+  bs.reader().peek_all( views );
+  string joined;
+  for ( const auto view : views ) {
+    joined += view;
+  }
+  if ( joined != string( "fghijk" ).substr( 0, N - 3 ) ) {
+    throw runtime_error( "StaticByteStream peek_all() did not cover the buffer across the wrap point" );
+  }
+  bs.writer().close();
+  bs.reader().pop( 100 );
+  if ( not bs.reader().is_finished() or bs.reader().bytes_popped() != N + 2 ) {
+    throw runtime_error( "StaticByteStream did not finish after the last pop" );
+  }
+  bs.writer().push( "x" );
+  if ( not bs.has_error() ) {
+    throw runtime_error( "StaticByteStream push() after close() did not set error" );
+  }
+}
+
+// Drive a StaticByteStream and a ByteStream of the same capacity with the same random operations.
+template<uint64_t N>
+void compare_test( const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<size_t> op_size { 0, N + 3 };
+
+  StaticByteStream<N> fixed;
+  ByteStream reference { N };
+  for ( size_t i = 0; i < 10000; ++i ) {
+    const string data = random_bytes( op_size( rd ), rd() );
+    fixed.writer().push( data );
+    reference.writer().push( data );
+
+    const size_t len = op_size( rd );
+    string fixed_out( len, 0 );
+    fixed_out.resize( fixed.reader().read_into( fixed_out ) );
+    string reference_out;
+    read( reference.reader(), len, reference_out );
+    if ( fixed_out != reference_out or fixed.reader().bytes_buffered() != reference.reader().bytes_buffered()
+         or fixed.reader().peek() != reference.reader().peek() ) {
+      throw runtime_error( "StaticByteStream<" + to_string( N ) + "> diverged from ByteStream" );
+    }
+  }
+}
+
+int main()
+{
+  try {
+    basic_test<4>();
+    basic_test<5>();
+    compare_test<16>( 1 );
+    compare_test<17>( 2 );
+    compare_test<1500>( 3 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+#include "byte_stream.hh"
+#include "static_byte_stream.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+constexpr uint64_t kCapacity = 256;
+
+template<typename Stream>
+Stream make_stream()
+{
+  if constexpr ( is_same_v<Stream, ByteStream> ) {
+    return ByteStream { kCapacity };
+  } else {
+    // Default-initialized, as a short-lived stream would be declared: the inline buffer is left uninitialized.
+    Stream bs;
+    return bs;
+  }
+}
+
+// Build a short-lived control stream, pass one message through it, and tear it down again.
+template<typename Stream>
+double construct_test( const string& message, const size_t rounds, uint64_t& checksum )
+{
+  string out( message.size(), 0 );
+  const auto start_time = steady_clock::now();
+  for ( size_t i = 0; i < rounds; ++i ) {
+    Stream bs = make_stream<Stream>();
+    bs.writer().push( message );
+    checksum += bs.reader().read_into( span { out } );
+    checksum += static_cast<unsigned char>( out[i % out.size()] );
+  }
+  const auto elapsed = duration_cast<duration<double, nano>>( steady_clock::now() - start_time );
+  return elapsed.count() / static_cast<double>( rounds );
+}
+
+// Push and drain one message at a time on randomly chosen streams out of a working set too big for L2.
+template<typename Stream>
+double working_set_test( vector<Stream>& streams,
+                         const string& message,
+                         const vector<uint32_t>& order,
+                         uint64_t& checksum )
+{
+  string out( message.size(), 0 );
+  const auto start_time = steady_clock::now();
+  for ( const auto index : order ) {
+    auto& bs = streams[index];
+    bs.writer().push( message );
+    checksum += bs.reader().read_into( span { out } );
+  }
+  const auto elapsed = duration_cast<duration<double, nano>>( steady_clock::now() - start_time );
+  return elapsed.count() / static_cast<double>( order.size() );
+}
+
+} // namespace
+
+void speed_test( const size_t num_streams, const size_t num_ops, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  const string message( 37, 'c' );
+  uniform_int_distribution<uint32_t> pick { 0, static_cast<uint32_t>( num_streams - 1 ) };
+  vector<uint32_t> order( num_ops );
+  for ( auto& x : order ) {
+    x = pick( rd );
+  }
+
+  uint64_t checksum = 0;
+  const double dynamic_construct = construct_test<ByteStream>( message, num_ops, checksum );
+  const double static_construct = construct_test<StaticByteStream<kCapacity>>( message, num_ops, checksum );
+
+  vector<ByteStream> dynamic_streams;
+  dynamic_streams.reserve( num_streams );
+  for ( size_t i = 0; i < num_streams; ++i ) {
+    dynamic_streams.emplace_back( kCapacity );
+  }
+  vector<StaticByteStream<kCapacity>> masked_streams( num_streams );
+  vector<StaticByteStream<kCapacity - 1>> modulo_streams( num_streams );
+
+  const double dynamic_ns = working_set_test( dynamic_streams, message, order, checksum );
+  const double masked_ns = working_set_test( masked_streams, message, order, checksum );
+  const double modulo_ns = working_set_test( modulo_streams, message, order, checksum );
+
+  const uint64_t expected = 2 * num_ops * message.size() + 2 * num_ops * 'c' + 3 * num_ops * message.size();
+  if ( checksum != expected ) {
+    throw runtime_error( "StaticByteStream benchmark lost bytes" );
+  }
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << fixed << setprecision( 2 ) << "Construct + one message: ByteStream " << dynamic_construct
+       << " ns, StaticByteStream " << static_construct << " ns. " << num_streams << " streams of "
+       << kCapacity << " bytes (" << sizeof( ByteStream ) << "-byte object + heap buffer vs "
+       << sizeof( StaticByteStream<kCapacity> ) << " bytes inline): ByteStream " << dynamic_ns
+       << " ns/op, StaticByteStream " << masked_ns << " ns/op (masked), " << modulo_ns
+       << " ns/op (capacity " << kCapacity - 1 << ", modulo).\n";
+
+  debug_output << "     StaticByteStream: " << fixed << setprecision( 2 ) << static_construct
+               << " ns/construct (ByteStream " << dynamic_construct << " ns), " << masked_ns
+               << " ns/op (ByteStream " << dynamic_ns << " ns/op)\n";
+}
+
+void program_body()
+{
+  speed_test( 65536, 4000000, 1067 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -5,7 +5,9 @@
 
 #include <concepts>
 #include <optional>
+#include <span>
 #include <utility>
+#include <vector>
 
 static_assert( sizeof( Reader ) == sizeof( ByteStream ),
                "Please add member variables to the ByteStream base, not the ByteStream Reader." );
@@ -20,6 +22,10 @@ public:
     : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
   {}
 
+  ByteStreamTestHarness( std::string test_name, uint64_t capacity, ByteStream::Storage storage )
+    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity, storage } )
+  {}
+
   size_t peek_size() { return object().reader().peek().size(); }
 };
 
@@ -34,6 +40,49 @@ struct Push : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.writer().push( data_ ); }
 };
 
+struct ReserveCommit : public Action<ByteStream>
+{
+  size_t reserve_len_;
+  std::string data_;
+
+  ReserveCommit( size_t reserve_len, std::string data ) : reserve_len_( reserve_len ), data_( move( data ) ) {}
+  std::string description() const override
+  {
+    return "reserve( " + std::to_string( reserve_len_ ) + " ), write \"" + Printer::prettify( data_ )
+           + "\" and commit";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    std::vector<std::span<char>> spans;
+    bs.writer().reserve( reserve_len_, spans );
+    size_t written = 0;
+    for ( const auto span : spans ) {
+      const size_t len = std::min( span.size(), data_.size() - written );
+      std::copy_n( data_.begin() + static_cast<ptrdiff_t>( written ), len, span.begin() );
+      written += len;
+    }
+    bs.writer().commit( written );
+  }
+};
+
+struct ReserveSize : public ExpectNumber<ByteStream, uint64_t>
+{
+  uint64_t len_;
+  ReserveSize( uint64_t len, uint64_t value ) : ExpectNumber( value ), len_( len ) {}
+  std::string name() const override { return "total size reserved by reserve( " + std::to_string( len_ ) + " )"; }
+  size_t value( ByteStream& bs ) const override
+  {
+    std::vector<std::span<char>> spans;
+    bs.writer().reserve( len_, spans );
+    size_t total = 0;
+    for ( const auto span : spans ) {
+      total += span.size();
+    }
+    bs.writer().commit( 0 );
+    return total;
+  }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -55,6 +104,15 @@ struct Pop : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.reader().pop( len_ ); }
 };
 
+struct SetCapacity : public Action<ByteStream>
+{
+  uint64_t capacity_;
+
+  explicit SetCapacity( uint64_t capacity ) : capacity_( capacity ) {}
+  std::string description() const override { return "set_capacity( " + std::to_string( capacity_ ) + " )"; }
+  void execute( ByteStream& bs ) const override { bs.writer().set_capacity( capacity_ ); }
+};
+
 /* expectations */
 
 struct Peek : public Expectation<ByteStream>
@@ -107,6 +165,39 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekAll : public Expectation<ByteStream>
+{
+  std::vector<std::string> output_;
+
+  explicit PeekAll( std::vector<std::string> output ) : output_( move( output ) ) {}
+
+  std::string description() const override
+  {
+    std::string ret = "peek_all() gives {";
+    for ( const auto& x : output_ ) {
+      ret += " \"" + Printer::prettify( x ) + "\"";
+    }
+    return ret + " }";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::vector<std::string_view> views;
+    bs.reader().peek_all( views );
+    if ( views.size() != output_.size() ) {
+      throw ExpectationViolation { "Expected " + std::to_string( output_.size() ) + " views from peek_all(), "
+                                   + "but got " + std::to_string( views.size() ) };
+    }
+    for ( size_t i = 0; i < views.size(); ++i ) {
+      if ( views[i] != output_[i] ) {
+        throw ExpectationViolation { "Expected view " + std::to_string( i ) + " to be \""
+                                     + Printer::prettify( output_[i] ) + "\", but found \""
+                                     + Printer::prettify( views[i] ) + "\"" };
+      }
+    }
+  }
+};
+
 struct IsClosed : public ConstExpectBool<ByteStream>
 {
   using ConstExpectBool::ConstExpectBool;
@@ -163,6 +254,60 @@ struct BytesPopped : public ExpectNumber<ByteStream, uint64_t>
   size_t value( ByteStream& bs ) const override { return bs.reader().bytes_popped(); }
 };
 
+struct ReadInto : public Expectation<ByteStream>
+{
+  size_t len_;
+  std::string output_;
+
+  ReadInto( size_t len, std::string output ) : len_( len ), output_( move( output ) ) {}
+
+  std::string description() const override
+  {
+    return "read_into( " + std::to_string( len_ ) + " bytes ) gives \"" + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::string got( len_, 0 );
+    got.resize( bs.reader().read_into( got ) );
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected read_into() to give \"" + Printer::prettify( output_ )
+                                   + "\", but found \"" + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
+struct ReadAppend : public Expectation<ByteStream>
+{
+  std::string prefix_;
+  std::string output_;
+
+  ReadAppend( std::string prefix, std::string output ) : prefix_( move( prefix ) ), output_( move( output ) ) {}
+
+  std::string description() const override
+  {
+    return "appending everything buffered to \"" + Printer::prettify( prefix_ ) + "\" gives \""
+           + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::string got = prefix_;
+    read( bs.reader(), got );
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected \"" + Printer::prettify( output_ ) + "\", but found \""
+                                   + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
+struct MemoryUsage : public ConstExpectNumber<ByteStream, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "memory_usage"; }
+  size_t value( const ByteStream& bs ) const override { return bs.memory_usage(); }
+};
+
 struct ReadAll : public Expectation<ByteStream>
 {
   std::string output_;
@@ -0,0 +1,94 @@
+#include "presence_bitmap.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Apply random range updates to a PresenceBitmap and to a vector<bool>, and compare every query.
+void random_test( const BitmapKernels& kernels, const size_t bits, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<size_t> index { 0, bits };
+  uniform_int_distribution<int> op { 0, 3 };
+
+  PresenceBitmap bitmap { bits, kernels };
+  vector<bool> reference( bits );
+  const string where = string { " (" } + kernels.name + ", " + to_string( bits ) + " bits)";
+
+  for ( size_t i = 0; i < 4000; ++i ) {
+    size_t begin = index( rd );
+    size_t end = index( rd );
+    if ( begin > end ) {
+      swap( begin, end );
+    }
+    switch ( op( rd ) ) {
+      case 0:
+        bitmap.set( begin, end );
+        for ( size_t j = begin; j < end; ++j ) {
+          reference[j] = true;
+        }
+        break;
+      case 1:
+        bitmap.clear( begin, end );
+        for ( size_t j = begin; j < end; ++j ) {
+          reference[j] = false;
+        }
+        break;
+      default:
+        break;
+    }
+
+    for ( const bool value : { false, true } ) {
+      size_t expected = begin;
+      while ( expected < end and reference[expected] != value ) {
+        ++expected;
+      }
+      check( bitmap.find( value, begin, end ) == expected, "find() disagrees with the reference" + where );
+
+      size_t last = end;
+      for ( size_t j = begin; j < end; ++j ) {
+        last = reference[j] == value ? j : last;
+      }
+      check( bitmap.rfind( value, begin, end ) == last, "rfind() disagrees with the reference" + where );
+    }
+    size_t ones = 0;
+    for ( size_t j = begin; j < end; ++j ) {
+      ones += reference[j] ? 1 : 0;
+    }
+    check( bitmap.count( begin, end ) == ones, "count() disagrees with the reference" + where );
+    check( begin == bits or bitmap.test( begin ) == reference[begin],
+           "test() disagrees with the reference" + where );
+  }
+}
+
+int main()
+{
+  try {
+    for ( const auto* kernels : BitmapKernels::available() ) {
+      // Runs that end exactly on a word or vector boundary
+      vector<uint64_t> words( 37, ~uint64_t {} );
+      check( kernels->find_word( words.data(), words.size(), ~uint64_t {} ) == words.size(), "found a mismatch" );
+      for ( size_t i = 0; i < words.size(); ++i ) {
+        words[i] = ~uint64_t { 1 };
+        check( kernels->find_word( words.data(), words.size(), ~uint64_t {} ) == i, "missed a mismatch" );
+        check( kernels->popcount( words.data(), words.size() ) == 64 * words.size() - 1, "miscounted" );
+        words[i] = ~uint64_t {};
+      }
+
+      for ( const size_t bits : { 0UL, 1UL, 63UL, 64UL, 65UL, 700UL, 4096UL } ) {
+        random_test( *kernels, bits, bits + 1 );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include "presence_bitmap.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+constexpr size_t kBits = size_t { 1 } << 20; // one bit per byte of a 1 MiB window
+
+struct Pattern
+{
+  string name;
+  function<bool( size_t )> bit;
+};
+
+// Visit every run of set bits the way the Reassembler does: find the next byte held, then the end of its run.
+size_t walk_runs( const PresenceBitmap& bitmap )
+{
+  size_t runs = 0;
+  for ( size_t pos = bitmap.find( true, 0, kBits ); pos < kBits; pos = bitmap.find( true, pos, kBits ) ) {
+    pos += bitmap.run( pos, kBits );
+    ++runs;
+  }
+  return runs;
+}
+
+template<typename F>
+double time_ns( const size_t rounds, F&& f )
+{
+  const auto start_time = steady_clock::now();
+  for ( size_t i = 0; i < rounds; ++i ) {
+    f();
+  }
+  const auto elapsed = duration_cast<duration<double, nano>>( steady_clock::now() - start_time );
+  return elapsed.count() / static_cast<double>( rounds );
+}
+
+} // namespace
+
+void speed_test( const size_t rounds )
+{
+  const vector<Pattern> patterns {
+    { "sparse", []( size_t i ) { return i % 4096 == 0; } },
+    { "dense", []( size_t i ) { return i % 4096 != 0; } },
+    { "alternating", []( size_t i ) { return i % 128 < 100; } },
+  };
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  for ( const auto& pattern : patterns ) {
+    double scalar_scan = 0;
+    double best_scan = 0;
+    size_t expected_runs = 0;
+    size_t expected_count = 0;
+    for ( const auto* kernels : BitmapKernels::available() ) {
+      PresenceBitmap bitmap { kBits, *kernels };
+      for ( size_t i = 0; i < kBits; ++i ) {
+        if ( pattern.bit( i ) ) {
+          bitmap.set( i, i + 1 );
+        }
+      }
+
+      size_t runs = 0;
+      size_t ones = 0;
+      const double scan_ns = time_ns( rounds, [&] { runs = walk_runs( bitmap ); } );
+      const double count_ns = time_ns( rounds, [&] { ones = bitmap.count( 0, kBits ); } );
+      if ( kernels == &BitmapKernels::scalar() ) {
+        expected_runs = runs;
+        expected_count = ones;
+        scalar_scan = scan_ns;
+      } else if ( runs != expected_runs or ones != expected_count ) {
+        throw runtime_error( string { "kernel " } + kernels->name + " disagrees with the scalar kernel" );
+      }
+      best_scan = scan_ns;
+
+      cout << fixed << setprecision( 1 ) << setw( 12 ) << pattern.name << setw( 8 ) << kernels->name
+           << ": walk " << runs << " runs in " << scan_ns / 1000 << " us, count " << ones << " bits in "
+           << count_ns / 1000 << " us\n";
+    }
+
+    debug_output << "  PresenceBitmap " << setw( 12 ) << pattern.name << ": " << fixed << setprecision( 2 )
+                 << scalar_scan / best_scan << "x (" << BitmapKernels::best().name << " vs scalar)\n";
+  }
+}
+
+void program_body()
+{
+  speed_test( 200 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
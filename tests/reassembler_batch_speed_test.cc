@@ -0,0 +1,119 @@
+#include "reassembler.hh"
+#include "test_utils.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+constexpr size_t kSegmentSize = 1460;
+
+struct Result
+{
+  double gigabits_per_second;
+  double ns_per_batch;
+};
+
+// Deliver the whole stream in batches of `batch_size` segments, either through insert_many() or through one
+// insert() per segment, and drain the output after each batch (one recvmmsg wakeup followed by one read).
+Result run( const vector<Reassembler::Substring>& segments,
+            const size_t batch_size,
+            const size_t stream_len,
+            const bool batched,
+            string& output )
+{
+  // The payloads are slices of one buffer, as a recvmmsg into a single arena would give; copying the vector
+  // only copies the slice handles, and it happens before timing
+  vector<Reassembler::Substring> work = segments;
+  Reassembler reassembler { ByteStream { 2 * 64 * kSegmentSize } };
+  output.clear();
+
+  const auto start_time = steady_clock::now();
+  for ( size_t i = 0; i < work.size(); i += batch_size ) {
+    const span batch { work.data() + i, min( batch_size, work.size() - i ) };
+    if ( batched ) {
+      reassembler.insert_many( batch );
+    } else {
+      for ( auto& sub : batch ) {
+        reassembler.insert( sub.first_index, move( sub.data ), sub.is_last_substring );
+      }
+    }
+    read( reassembler.reader(), output );
+  }
+  const auto elapsed = duration_cast<duration<double>>( steady_clock::now() - start_time );
+
+  if ( not reassembler.reader().is_finished() or output.size() != stream_len ) {
+    throw runtime_error( "Reassembler did not deliver the whole stream" );
+  }
+  const double batches = static_cast<double>( ( work.size() + batch_size - 1 ) / batch_size );
+  return { 8 * static_cast<double>( stream_len ) / elapsed.count() / 1e9, elapsed.count() * 1e9 / batches };
+}
+
+} // namespace
+
+void speed_test( const size_t num_segments, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  const string data = random_bytes( num_segments * kSegmentSize, random_seed );
+
+  // MSS-sized segments, mostly in order: one adjacent pair in eight arrives swapped
+  const BufferSlice arena { data };
+  vector<Reassembler::Substring> segments;
+  for ( size_t i = 0; i < data.size(); i += kSegmentSize ) {
+    segments.push_back( { i, arena.substr( i, kSegmentSize ), i + kSegmentSize >= data.size() } );
+  }
+  uniform_int_distribution<int> swap_dist { 0, 7 };
+  for ( size_t i = 0; i + 1 < segments.size(); i += 2 ) {
+    if ( swap_dist( rd ) == 0 ) {
+      swap( segments[i], segments[i + 1] );
+    }
+  }
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  string output( data.size(), 0 );
+  for ( const size_t batch_size : { 1, 8, 32, 64 } ) {
+    const Result single = run( segments, batch_size, data.size(), false, output );
+    const Result batched = run( segments, batch_size, data.size(), true, output );
+    if ( output != data ) {
+      throw runtime_error( "Mismatch between data written and read" );
+    }
+
+    cout << "batch=" << setw( 2 ) << batch_size << ": insert() " << fixed << setprecision( 2 )
+         << single.gigabits_per_second << " Gbit/s (" << setprecision( 0 ) << single.ns_per_batch
+         << " ns/batch), insert_many() " << setprecision( 2 ) << batched.gigabits_per_second << " Gbit/s ("
+         << setprecision( 0 ) << batched.ns_per_batch << " ns/batch), speedup " << setprecision( 2 )
+         << single.ns_per_batch / batched.ns_per_batch << "x\n";
+
+    debug_output << "  Reassembler batch=" << batch_size << ": " << fixed << setprecision( 2 )
+                 << batched.gigabits_per_second << " Gbit/s\n";
+
+    if ( batched.gigabits_per_second < 0.1 ) {
+      throw runtime_error( "Reassembler::insert_many did not meet minimum speed of 0.1 Gbit/s." );
+    }
+  }
+}
+
+int main()
+{
+  try {
+    speed_test( 20000, 1370 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include "reassembler_test_harness.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "bitmap: holes and overlaps", 8, Reassembler::Engine::Bitmap };
+
+      test.execute( Insert { "cd", 2 } );
+      test.execute( Insert { "fgh", 5 } );
+      test.execute( BytesPending { 5 } );
+      test.execute( Insert { "defg", 3 } );
+      test.execute( BytesPending { 6 } );
+      test.execute( BytesPushed( 0 ) );
+      test.execute( Insert { "abc", 0 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( ReadAll( "abcdefgh" ) );
+      test.execute( IsFinished { false } );
+    }
+
+    {
+      ReassemblerTestHarness test { "bitmap: window wraps around the ring", 4, Reassembler::Engine::Bitmap };
+
+      test.execute( Insert { "abc", 0 } );
+      test.execute( ReadAll( "abc" ) );
+      test.execute( Insert { "fghij", 5 } );
+      test.execute( BytesPending { 2 } );
+      test.execute( Insert { "de", 3 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( BytesPushed( 7 ) );
+      test.execute( ReadAll( "defg" ) );
+      test.execute( Insert { "hij", 7 }.is_last() );
+      test.execute( ReadAll( "hij" ) );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ReassemblerTestHarness test { "bitmap: last segment first", 16, Reassembler::Engine::Bitmap };
+
+      test.execute( Insert { "", 6 }.is_last() );
+      test.execute( Insert { "def", 3 } );
+      test.execute( IsFinished { false } );
+      test.execute( Insert { "abc", 0 } );
+      test.execute( ReadAll( "abcdef" ) );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ReassemblerTestHarness test { "bitmap: beyond capacity is discarded", 2, Reassembler::Engine::Bitmap };
+
+      test.execute( Insert { "bcd", 1 } );
+      test.execute( BytesPending { 1 } );
+      test.execute( Insert { "a", 0 } );
+      test.execute( ReadAll( "ab" ) );
+      test.execute( Insert { "", 2 }.is_last() );
+      test.execute( IsFinished { true } );
+    }
+
+    // Random segments give the same results as with the Segments engine
+    size_t seed = 0;
+    for ( const auto& [capacity, stream_len] :
+          { pair { 1UL, 200UL }, { 7UL, 2000UL }, { 64UL, 20000UL }, { 1000UL, 200000UL } } ) {
+      differential_check( Reassembler { ByteStream { capacity }, Reassembler::Engine::Bitmap },
+                          Reassembler { ByteStream { capacity } },
+                          stream_len,
+                          ++seed );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
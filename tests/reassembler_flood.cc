@@ -0,0 +1,114 @@
+#include "reassembler.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    const string data = pattern_data( 65536 );
+
+    {
+      // One-byte segments that touch each other are coalesced instead of held one node per byte
+      Reassembler r { ByteStream { 65536 } };
+      for ( size_t i = 1; i < 32768; ++i ) {
+        r.insert( i, data.substr( i, 1 ), false );
+      }
+      const auto stats = r.stats();
+      check( r.bytes_pending() == 32767, "adjacent one-byte segments were lost" );
+      check( stats.segments_held <= 32768 / 128 + 1, "adjacent one-byte segments were not coalesced" );
+      check( stats.merges > 32000 and stats.evictions == 0, "wrong merge/eviction counters" );
+
+      r.insert( 0, data.substr( 0, 1 ), false );
+      string out;
+      read( r.reader(), out );
+      check( out == data.substr( 0, 32768 ), "coalesced segments delivered the wrong bytes" );
+      check( r.stats().segments_held == 0, "delivered segments are still held" );
+    }
+
+    {
+      // Every other byte: nothing can be merged, so the segment cap holds and the farthest segments go first
+      Reassembler r { ByteStream { 65536 } };
+      for ( size_t i = 1; i < 65536; i += 2 ) {
+        r.insert( i, data.substr( i, 1 ), false );
+      }
+      const auto stats = r.stats();
+      check( stats.segments_held == 256, "the segment cap was not enforced: " + to_string( stats.segments_held ) );
+      check( stats.evictions == 32768 - 256, "wrong eviction count" );
+      check( r.bytes_pending() == 256, "evicted bytes are still counted as pending" );
+
+      // The segments kept are the ones nearest the delivery point, so filling the gaps makes progress
+      for ( size_t i = 0; i < 512; i += 2 ) {
+        r.insert( i, data.substr( i, 1 ), false );
+      }
+      check( r.writer().bytes_pushed() == 512, "the nearest segments were not the ones kept" );
+
+      // Retransmitting the rest in full completes the stream
+      r.insert( 0, data, true );
+      string out;
+      read( r.reader(), out );
+      check( out == data and r.reader().is_finished(), "stream did not complete after evictions" );
+    }
+
+    {
+      // Ordinary out-of-order MSS-sized segments are neither merged nor evicted
+      Reassembler r { ByteStream { 65536 } };
+      for ( size_t i = 1460; i + 1460 <= 65536; i += 1460 ) {
+        r.insert( i, data.substr( i, 1460 ), false );
+      }
+      const auto stats = r.stats();
+      check( stats.merges == 0 and stats.evictions == 0, "normal segments were merged or evicted" );
+      check( stats.segments_held == 65536 / 1460 - 1, "wrong segment count" );
+    }
+
+    {
+      // A lower cap set explicitly; eviction is deterministic, so two identical runs keep identical segments
+      default_random_engine rd { 7 };
+      uniform_int_distribution<size_t> pos { 1, 4000 };
+      vector<size_t> indices( 2000 );
+      for ( auto& i : indices ) {
+        i = pos( rd );
+      }
+      uint64_t pending[2] {};
+      for ( auto& p : pending ) {
+        Reassembler r { ByteStream { 4096 } };
+        r.set_max_segments( 16 );
+        for ( const auto i : indices ) {
+          r.insert( i, data.substr( i, 3 ), false );
+        }
+        check( r.stats().segments_held <= 16, "explicit segment cap was not enforced" );
+        p = r.bytes_pending();
+      }
+      check( pending[0] == pending[1], "eviction was not deterministic" );
+    }
+
+    {
+      // The default cap follows the capacity down as well as up; an explicit cap survives resizing
+      const auto flood = []( Reassembler& r ) {
+        for ( size_t i = 1; i < 1000; i += 2 ) {
+          r.insert( i, "x", false );
+        }
+        return r.stats().segments_held;
+      };
+      Reassembler grown { ByteStream { 16384 } };
+      check( grown.set_capacity( 1 << 20 ) and grown.set_capacity( 16384 ), "resizing an empty Reassembler failed" );
+      check( flood( grown ) == 64, "segment cap not recomputed after shrinking" );
+
+      Reassembler fixed { ByteStream { 16384 } };
+      fixed.set_max_segments( 16 );
+      check( fixed.set_capacity( 1 << 20 ), "resizing an empty Reassembler failed" );
+      check( flood( fixed ) == 16, "explicit segment cap overridden by set_capacity()" );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
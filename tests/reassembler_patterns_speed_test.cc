@@ -0,0 +1,197 @@
+#include "reassembler.hh"
+#include "test_utils.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+// One segment to insert, as (offset in the window, length)
+using Plan = vector<pair<size_t, size_t>>;
+
+struct Pattern
+{
+  string name;
+  size_t capacity;
+  size_t segment_size;
+  size_t stream_len;
+  double min_gigabits_per_second;
+  // The order (and repetition) in which one window's worth of segments arrives
+  function<void( Plan&, default_random_engine& )> arrange;
+};
+
+// The segments covering a window of `window` bytes, in order
+Plan in_order( const size_t window, const size_t segment_size )
+{
+  Plan plan;
+  for ( size_t offset = 0; offset < window; offset += segment_size ) {
+    plan.emplace_back( offset, min( segment_size, window - offset ) );
+  }
+  return plan;
+}
+
+struct Result
+{
+  double gigabits_per_second;
+  double inserts_per_second;
+  uint64_t peak_pending;
+  size_t retransmits;
+};
+
+// Deliver the stream one window at a time: insert the window's segments in the pattern's order, retransmit the
+// whole window if the Reassembler had to drop some of it, then drain the output
+Result run( const Pattern& pattern, const string& data, const Reassembler::Engine engine )
+{
+  // Build every insert up front so that generating and copying payloads is not timed
+  default_random_engine rd { 1370 };
+  vector<vector<pair<uint64_t, string>>> windows;
+  for ( size_t base = 0; base < pattern.stream_len; base += pattern.capacity ) {
+    const size_t window = min( pattern.capacity, pattern.stream_len - base );
+    Plan plan = in_order( window, pattern.segment_size );
+    pattern.arrange( plan, rd );
+    auto& inserts = windows.emplace_back();
+    for ( const auto& [offset, len] : plan ) {
+      inserts.emplace_back( base + offset, data.substr( base + offset, len ) );
+    }
+  }
+
+  Reassembler reassembler { ByteStream { pattern.capacity }, engine };
+  string output;
+  output.reserve( pattern.stream_len );
+  size_t inserts = 0;
+  Result result {};
+
+  const auto start_time = steady_clock::now();
+  for ( size_t w = 0; w < windows.size(); ++w ) {
+    for ( auto& [index, payload] : windows[w] ) {
+      reassembler.insert( index, move( payload ), index + payload.size() == pattern.stream_len );
+      result.peak_pending = max( result.peak_pending, reassembler.bytes_pending() );
+    }
+    inserts += windows[w].size();
+
+    const size_t base = w * pattern.capacity;
+    const size_t window_end = min( base + pattern.capacity, pattern.stream_len );
+    if ( reassembler.writer().bytes_pushed() < window_end ) {
+      reassembler.insert( base, data.substr( base, window_end - base ), window_end == pattern.stream_len );
+      ++inserts;
+      ++result.retransmits;
+    }
+    read( reassembler.reader(), output );
+  }
+  const auto elapsed = duration_cast<duration<double>>( steady_clock::now() - start_time );
+
+  if ( not reassembler.reader().is_finished() ) {
+    throw runtime_error( pattern.name + ": Reassembler did not close ByteStream when finished" );
+  }
+  if ( output != data.substr( 0, pattern.stream_len ) ) {
+    throw runtime_error( pattern.name + ": mismatch between data written and read" );
+  }
+
+  result.gigabits_per_second = 8 * static_cast<double>( pattern.stream_len ) / elapsed.count() / 1e9;
+  result.inserts_per_second = static_cast<double>( inserts ) / elapsed.count();
+  return result;
+}
+
+} // namespace
+
+void program_body()
+{
+  const vector<Pattern> patterns {
+    { "in-order", 64000, 1000, 8 << 20, 0.1, []( Plan&, default_random_engine& ) {} },
+    { "reverse", 64000, 1000, 8 << 20, 0.1, []( Plan& plan, default_random_engine& ) { ranges::reverse( plan ); } },
+    { "random-permutation",
+      64000,
+      1000,
+      8 << 20,
+      0.1,
+      []( Plan& plan, default_random_engine& rd ) { ranges::shuffle( plan, rd ); } },
+    { "heavy-duplication",
+      64000,
+      1000,
+      4 << 20,
+      0.1,
+      // Every segment arrives four times: once as sent, three times shifted by up to half a segment
+      []( Plan& plan, default_random_engine& rd ) {
+        const size_t window = plan.back().first + plan.back().second;
+        uniform_int_distribution<size_t> shift { 0, 1000 };
+        const size_t n = plan.size();
+        for ( size_t i = 0; i < n; ++i ) {
+          for ( int copy = 0; copy < 3; ++copy ) {
+            const size_t first = min( max( plan[i].first + shift( rd ), size_t { 500 } ) - 500, window - 1 );
+            plan.emplace_back( first, min( plan[i].second, window - first ) );
+          }
+        }
+        ranges::shuffle( plan, rd );
+      } },
+    { "tiny-segments",
+      4096,
+      1,
+      256 << 10,
+      0.001,
+      []( Plan& plan, default_random_engine& rd ) { ranges::shuffle( plan, rd ); } },
+    { "large-window",
+      2 << 20,
+      1460,
+      16 << 20,
+      0.1,
+      []( Plan& plan, default_random_engine& rd ) { ranges::shuffle( plan, rd ); } },
+    { "last-segment-first",
+      64000,
+      1000,
+      8 << 20,
+      0.1,
+      []( Plan& plan, default_random_engine& ) { ranges::rotate( plan, plan.end() - 1 ); } },
+  };
+
+  const string data = random_bytes( 16 << 20, 1370 );
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  for ( const auto& pattern : patterns ) {
+    for ( const auto& [engine, engine_name] : { pair { Reassembler::Engine::Segments, "segments" },
+                                                pair { Reassembler::Engine::Bitmap, "bitmap" },
+                                                pair { Reassembler::Engine::Shared, "shared" } } ) {
+      const Result result = run( pattern, data, engine );
+      cout << left << setw( 19 ) << pattern.name << setw( 9 ) << engine_name << right << fixed << setprecision( 2 )
+           << setw( 7 ) << result.gigabits_per_second << " Gbit/s " << setw( 7 ) << result.inserts_per_second / 1e6
+           << " M inserts/s  peak bytes_pending " << setw( 8 ) << result.peak_pending;
+      if ( result.retransmits > 0 ) {
+        cout << "  (" << result.retransmits << " windows retransmitted)";
+      }
+      cout << "\n";
+
+      debug_output << "  Reassembler " << pattern.name << " (" << engine_name << "): " << fixed
+                   << setprecision( 2 ) << result.gigabits_per_second << " Gbit/s\n";
+
+      if ( result.gigabits_per_second < pattern.min_gigabits_per_second ) {
+        throw runtime_error( "Reassembler (" + string { engine_name } + ") did not meet minimum speed on the "
+                             + pattern.name + " pattern." );
+      }
+    }
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+#include "reassembler.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+using Range = Reassembler::Range;
+
+vector<Range> held( const Reassembler& r )
+{
+  vector<Range> ret;
+  for ( const auto& range : r.held_ranges() ) {
+    ret.push_back( range );
+  }
+  return ret;
+}
+
+vector<Range> recent( const Reassembler& r )
+{
+  return { r.recent_ranges().begin(), r.recent_ranges().end() };
+}
+
+string str( const vector<Range>& ranges )
+{
+  string ret;
+  for ( const auto& range : ranges ) {
+    ret += "[" + to_string( range.first ) + ", " + to_string( range.last ) + ") ";
+  }
+  return ret;
+}
+
+void expect( const vector<Range>& actual, const vector<Range>& expected, const string& what )
+{
+  check( actual == expected, what + ": expected " + str( expected ) + "but got " + str( actual ) );
+}
+
+// The RFC 2018 ordering, checked step by step for one engine
+void scripted_test( const Reassembler::Engine engine )
+{
+  const string data = pattern_data( 1000 );
+  Reassembler r { ByteStream { 1000 }, engine };
+  const auto insert
+    = [&]( size_t first, size_t last ) { r.insert( first, data.substr( first, last - first ), false ); };
+
+  insert( 100, 110 );
+  insert( 200, 210 );
+  insert( 300, 310 );
+  expect( held( r ), { { 100, 110 }, { 200, 210 }, { 300, 310 } }, "held ranges" );
+  expect( recent( r ), { { 300, 310 }, { 200, 210 }, { 100, 110 } }, "most recent first" );
+
+  // Extending a block grows it and moves it to the front
+  insert( 110, 120 );
+  expect( recent( r ), { { 100, 120 }, { 300, 310 }, { 200, 210 } }, "extended block moves to the front" );
+
+  // A duplicate still moves its block to the front
+  insert( 305, 308 );
+  expect( recent( r ), { { 300, 310 }, { 100, 120 }, { 200, 210 } }, "duplicate moves its block to the front" );
+
+  // Filling the gap between two blocks joins them into one
+  insert( 210, 300 );
+  expect( held( r ), { { 100, 120 }, { 200, 310 } }, "joined ranges" );
+  expect( recent( r ), { { 200, 310 }, { 100, 120 } }, "joined block replaces both" );
+
+  // Only four blocks are remembered; the oldest drops out
+  insert( 400, 410 );
+  insert( 500, 510 );
+  insert( 600, 610 );
+  expect( recent( r ), { { 600, 610 }, { 500, 510 }, { 400, 410 }, { 200, 310 } }, "at most four blocks" );
+  check( held( r ).size() == 5, "a block dropped out of the recent list was lost" );
+
+  // Delivered blocks disappear from both views
+  insert( 0, 100 );
+  insert( 120, 200 );
+  expect( held( r ), { { 400, 410 }, { 500, 510 }, { 600, 610 } }, "held ranges after delivery" );
+  expect( recent( r ), { { 600, 610 }, { 500, 510 }, { 400, 410 } }, "recent ranges after delivery" );
+
+  // In-order data never shows up as a block
+  insert( 310, 350 );
+  expect( recent( r ), { { 600, 610 }, { 500, 510 }, { 400, 410 } }, "in-order data listed as a block" );
+}
+
+// Random inserts: the views always describe exactly the bytes held, and the newest block covers the last insert.
+// Every insert walks all the held ranges, so the stream is kept short enough for the sanitized build's timeout.
+void random_test( const Reassembler::Engine engine, const size_t random_seed )
+{
+  const size_t capacity = 4096;
+  const string data = pattern_data( 1 << 14 );
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<size_t> ahead { 0, capacity + 64 };
+  uniform_int_distribution<size_t> len { 1, 200 };
+  uniform_int_distribution<int> read_dist { 0, 7 };
+
+  Reassembler r { ByteStream { capacity }, engine };
+  string out;
+  while ( r.writer().bytes_pushed() + capacity < data.size() ) {
+    const size_t first = r.writer().bytes_pushed() + ahead( rd );
+    const size_t size = len( rd );
+    r.insert( first, data.substr( first, size ), false );
+    if ( read_dist( rd ) == 0 ) {
+      read( r.reader(), out );
+    }
+
+    const auto ranges = held( r );
+    uint64_t total = 0;
+    uint64_t previous_end = r.writer().bytes_pushed();
+    for ( const auto& range : ranges ) {
+      check( range.first > previous_end, "held ranges are out of order, touching, or already delivered" );
+      total += range.size();
+      previous_end = range.last;
+    }
+    check( total == r.bytes_pending(), "held ranges do not add up to bytes_pending()" );
+
+    const auto latest = recent( r );
+    check( latest.size() <= Reassembler::kRecentRanges, "too many recent ranges" );
+    for ( size_t i = 0; i < latest.size(); ++i ) {
+      check( find( ranges.begin(), ranges.end(), latest[i] ) != ranges.end(), "stale recent range" );
+      check( find( latest.begin(), latest.begin() + i, latest[i] ) == latest.begin() + i, "repeated range" );
+    }
+    const size_t anchor = max<size_t>( first, r.writer().bytes_pushed() );
+    const bool held_anchor = any_of( ranges.begin(), ranges.end(), [&]( const Range& range ) {
+      return range.first <= anchor and anchor < range.last;
+    } );
+    if ( held_anchor ) {
+      check( not latest.empty() and latest[0].first <= anchor and anchor < latest[0].last,
+             "the first recent range does not contain the latest segment" );
+    }
+  }
+  check( out == data.substr( 0, out.size() ), "wrong bytes delivered" );
+}
+
+int main()
+{
+  try {
+    for ( const auto engine :
+          { Reassembler::Engine::Segments, Reassembler::Engine::Bitmap, Reassembler::Engine::Shared } ) {
+      scripted_test( engine );
+      for ( size_t seed = 1; seed <= 3; ++seed ) {
+        random_test( engine, seed );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,92 @@
+#include "reassembler_test_harness.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "shared: holes and overlaps", 8, Reassembler::Engine::Shared };
+
+      test.execute( Insert { "cd", 2 } );
+      test.execute( Insert { "fgh", 5 } );
+      test.execute( BytesPending { 5 } );
+      test.execute( Insert { "defg", 3 } );
+      test.execute( BytesPending { 6 } );
+      test.execute( BytesPushed( 0 ) );
+      test.execute( Insert { "abc", 0 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( ReadAll( "abcdefgh" ) );
+      test.execute( IsFinished { false } );
+    }
+
+    {
+      // Out-of-order bytes are written past the write position, across the end of the stream's ring buffer
+      ReassemblerTestHarness test { "shared: window wraps around the ring", 4, Reassembler::Engine::Shared };
+
+      test.execute( Insert { "abc", 0 } );
+      test.execute( ReadAll( "abc" ) );
+      test.execute( Insert { "fghij", 5 } );
+      test.execute( BytesPending { 2 } );
+      test.execute( BytesPushed( 3 ) );
+      test.execute( Insert { "de", 3 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( BytesPushed( 7 ) );
+      test.execute( ReadAll( "defg" ) );
+      test.execute( Insert { "hij", 7 }.is_last() );
+      test.execute( ReadAll( "hij" ) );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      // Bytes stored ahead of the gap survive the reader popping in between
+      ReassemblerTestHarness test { "shared: reads between stores", 6, Reassembler::Engine::Shared };
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( Insert { "ef", 4 } );
+      test.execute( ReadAll( "ab" ) );
+      test.execute( Insert { "gh", 6 } );
+      test.execute( BytesPending { 4 } );
+      test.execute( Insert { "cd", 2 } );
+      test.execute( ReadAll( "cdefgh" ) );
+      test.execute( Insert { "", 8 }.is_last() );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ReassemblerTestHarness test { "shared: beyond capacity is discarded", 2, Reassembler::Engine::Shared };
+
+      test.execute( Insert { "bcd", 1 } );
+      test.execute( BytesPending { 1 } );
+      test.execute( Insert { "a", 0 } );
+      test.execute( ReadAll( "ab" ) );
+      test.execute( Insert { "", 2 }.is_last() );
+      test.execute( IsFinished { true } );
+    }
+
+    // Random segments give the same results as with the Segments engine, whatever the output's storage
+    const auto shared = []( size_t capacity, size_t stream_len, size_t seed, ByteStream::Storage storage ) {
+      differential_check( Reassembler { ByteStream { capacity, storage }, Reassembler::Engine::Shared },
+                          Reassembler { ByteStream { capacity } },
+                          stream_len,
+                          seed );
+    };
+    shared( 1, 200, 1, ByteStream::Storage::Ring );
+    shared( 7, 2000, 2, ByteStream::Storage::Ring );
+    shared( 1000, 200000, 3, ByteStream::Storage::Ring );
+    shared( 4096, 400000, 4, ByteStream::Storage::Mirrored );
+    // Storage that does not keep reserved bytes falls back to the Bitmap engine
+    shared( 1000, 200000, 5, ByteStream::Storage::Chunked );
+    shared( 4096, 400000, 6, ByteStream::Storage::Paged );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+#include "reassembler.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      // Cutting slices shares the storage
+      const BufferSlice whole { string { "abcdefgh" } };
+      BufferSlice part = whole.substr( 2, 4 );
+      check( part.view() == "cdef" and part.data() == whole.data() + 2, "substr() did not share storage" );
+      part.remove_prefix( 1 );
+      part.truncate( 2 );
+      check( part.view() == "de" and whole.view() == "abcdefgh", "trimming a slice changed another slice" );
+      part.remove_prefix( 10 );
+      check( part.empty(), "remove_prefix() past the end did not empty the slice" );
+    }
+
+    {
+      // Out-of-order, overlapping slices of one packet buffer end up in a Chunked stream without copies
+      const BufferSlice packet { string { "0123456789" } };
+      Reassembler reassembler { ByteStream { 8, ByteStream::Storage::Chunked } };
+
+      reassembler.insert( 4, packet.substr( 4, 4 ), false );
+      reassembler.insert( 3, packet.substr( 3, 3 ), false );
+      check( reassembler.bytes_pending() == 5, "wrong bytes_pending() for overlapping slices" );
+      reassembler.insert( 0, packet.substr( 0, 10 ), true );
+      check( reassembler.bytes_pending() == 0, "bytes left pending after the gap closed" );
+      check( reassembler.writer().bytes_pushed() == 8, "the window was not respected" );
+
+      vector<string_view> views;
+      reassembler.reader().peek_all( views );
+      string joined;
+      for ( const auto view : views ) {
+        check( view.data() >= packet.data() and view.data() + view.size() <= packet.data() + packet.size(),
+               "a delivered chunk does not point into the original packet buffer" );
+        joined += view;
+      }
+      check( joined == "01234567", "wrong bytes delivered: " + joined );
+
+      reassembler.reader().pop( 8 );
+      reassembler.insert( 8, packet.substr( 8 ), true );
+      check( reassembler.reader().peek() == "89" and reassembler.reader().peek().data() == packet.data() + 8,
+             "the final slice was copied" );
+      reassembler.reader().pop( 2 );
+      check( reassembler.reader().is_finished(), "stream did not finish" );
+    }
+
+    {
+      // The same slices through a Ring stream and the Bitmap engine are copied once, into the stream
+      const BufferSlice packet { string { "abcdef" } };
+      Reassembler reassembler { ByteStream { 16 }, Reassembler::Engine::Bitmap };
+      reassembler.insert( 2, packet.substr( 2 ), true );
+      reassembler.insert( 0, packet.substr( 0, 3 ), false );
+      string out;
+      read( reassembler.reader(), out );
+      check( out == "abcdef" and reassembler.reader().is_finished(), "Bitmap engine mishandled slices" );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -13,9 +13,11 @@
 using namespace std;
 using namespace std::chrono;
 
-void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
+double speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-parameters)
+                   const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
+                   const size_t random_seed,  // NOLINT(bugprone-easily-swappable-parameters)
+                   const Reassembler::Engine engine,
+                   const string& engine_name )
 {
   // Generate the data to be written
   const string data = [&] {
@@ -36,10 +38,11 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
     split_data.emplace( i + 1, data.substr( i + 1, capacity * 2 ), i + 1 + capacity * 2 >= data.size() );
   }
 
-  Reassembler reassembler { ByteStream { capacity } };
+  Reassembler reassembler { ByteStream { capacity }, engine };
 
-  string output_data;
-  output_data.reserve( data.size() );
+  // Touch the output buffer before timing so page faults on it are not charged to the Reassembler
+  string output_data( data.size(), 0 );
+  output_data.clear();
 
   const auto start_time = steady_clock::now();
   while ( not split_data.empty() ) {
@@ -47,10 +50,7 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
     reassembler.insert( get<uint64_t>( next ), move( get<string>( next ) ), get<bool>( next ) );
     split_data.pop();
 
-    while ( reassembler.reader().bytes_buffered() ) {
-      output_data += reassembler.reader().peek();
-      reassembler.reader().pop( output_data.size() - reassembler.reader().bytes_popped() );
-    }
+    read( reassembler.reader(), output_data );
   }
 
   const auto stop_time = steady_clock::now();
@@ -71,20 +71,25 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
   fstream debug_output;
   debug_output.open( "/dev/tty" );
 
-  cout << "Reassembler to ByteStream with capacity=" << capacity << " reached " << fixed << setprecision( 2 )
-       << gigabits_per_second << " Gbit/s.\n";
+  cout << "Reassembler (" << engine_name << ") to ByteStream with capacity=" << capacity << " reached " << fixed
+       << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
 
-  debug_output << "             Reassembler throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
-               << " Gbit/s\n";
+  debug_output << "  Reassembler throughput (" << engine_name << "): " << fixed << setprecision( 2 )
+               << gigabits_per_second << " Gbit/s\n";
 
   if ( gigabits_per_second < 0.1 ) {
     throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s." );
   }
+  return gigabits_per_second;
 }
 
 void program_body()
 {
-  speed_test( 10000, 1500, 1370 );
+  const double segments = speed_test( 10000, 1500, 1370, Reassembler::Engine::Segments, "segments" );
+  const double bitmap = speed_test( 10000, 1500, 1370, Reassembler::Engine::Bitmap, "bitmap" );
+  const double shared = speed_test( 10000, 1500, 1370, Reassembler::Engine::Shared, "shared" );
+  cout << "Bitmap engine speedup: " << fixed << setprecision( 2 ) << bitmap / segments << "x\n";
+  cout << "Shared engine speedup: " << fixed << setprecision( 2 ) << shared / segments << "x\n";
 }
 
 int main()
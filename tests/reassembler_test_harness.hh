@@ -33,6 +33,13 @@ public:
                    { Reassembler { ByteStream { capacity } } } )
   {}
 
+  ReassemblerTestHarness( std::string test_name, uint64_t capacity, Reassembler::Engine engine )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity )
+                     + ", engine=" + std::to_string( static_cast<int>( engine ) ),
+                   { Reassembler { ByteStream { capacity }, engine } } )
+  {}
+
   template<std::derived_from<TestStep<ByteStream>> T>
   void execute( const T& test )
   {
@@ -75,6 +75,20 @@ struct ExpectAckno : public ExpectNumber<TCPReceiver, std::optional<Wrap32>>
   std::optional<Wrap32> value( TCPReceiver& rs ) const override { return rs.send().ackno; }
 };
 
+struct ExpectScaledWindow : public ExpectNumber<TCPReceiver, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "window (unscaled bytes)"; }
+  uint64_t value( TCPReceiver& rs ) const override { return rs.send().window(); }
+};
+
+struct ExpectWindowShift : public ExpectNumber<TCPReceiver, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "window_shift"; }
+  uint64_t value( TCPReceiver& rs ) const override { return rs.send().window_shift; }
+};
+
 struct ExpectReset : public ExpectBool<TCPReceiver>
 {
   using ExpectBool::ExpectBool;
@@ -141,6 +155,12 @@ struct SegmentArrives : public Action<TCPReceiver>
     return *this;
   }
 
+  SegmentArrives& with_window_scale( uint8_t shift )
+  {
+    msg_.window_scale = shift;
+    return *this;
+  }
+
   SegmentArrives& with_seqno( Wrap32 seqno_ )
   {
     msg_.seqno = seqno_;
@@ -181,6 +201,9 @@ struct SegmentArrives : public Action<TCPReceiver>
     if ( msg_.FIN ) {
       ss << " +FIN";
     }
+    if ( msg_.window_scale ) {
+      ss << " wscale=" << static_cast<int>( *msg_.window_scale );
+    }
     ss << ")";
 
     if ( ackno_expected_.value_ ) {
@@ -0,0 +1,162 @@
+#include "tcp_receiver.hh"
+#include "test_utils.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// A window-limited sender on a link with a fixed RTT: at the start of every round trip it sends everything the
+// last ACK allows, in full-sized segments, and the application reads up to `drain` bytes before the next one.
+class Link
+{
+public:
+  Link( const TCPConfig& config, const bool peer_scales )
+    : receiver_( Reassembler { ByteStream { 64000 } }, config )
+  {
+    TCPSenderMessage syn;
+    syn.seqno = isn_;
+    syn.SYN = true;
+    if ( peer_scales ) {
+      syn.window_scale = 0;
+    }
+    receiver_.receive( syn );
+  }
+
+  // Returns the bytes sent in this round trip
+  uint64_t round_trip( const uint64_t rtt_ms, const uint64_t drain )
+  {
+    const uint64_t first = next_;
+    send( ack() - next_ );
+    receiver_.reader().pop( min( drain, receiver_.reader().bytes_buffered() ) );
+    receiver_.tick( rtt_ms );
+    return next_ - first;
+  }
+
+  // Takes the ACK the sender sees and returns the right edge of the window it advertises (a stream index)
+  uint64_t ack()
+  {
+    const TCPReceiverMessage message = receiver_.send_ack();
+    return receiver_.writer().bytes_pushed() + message.window();
+  }
+
+  // Sends `bytes` more of the stream in full-sized segments
+  void send( const uint64_t bytes )
+  {
+    for ( const uint64_t end = next_ + bytes; next_ < end; ) {
+      TCPSenderMessage message;
+      message.seqno = isn_ + 1 + static_cast<uint32_t>( next_ );
+      message.payload = string( min<uint64_t>( TCPConfig::MAX_PAYLOAD_SIZE, end - next_ ), 'x' );
+      next_ += message.payload.size();
+      receiver_.receive( move( message ) );
+      receiver_.maybe_send();
+    }
+  }
+
+  TCPReceiver& receiver() { return receiver_; }
+
+private:
+  TCPReceiver receiver_;
+  Wrap32 isn_ { 1000 };
+  uint64_t next_ {};
+};
+
+int main()
+{
+  try {
+    TCPConfig config;
+    config.recv_capacity_max = 4 << 20;
+
+    {
+      // An application that keeps up lets the buffer grow to the ceiling, and the sender fills it
+      Link link { config, true };
+      uint64_t last_round = 0;
+      for ( int i = 0; i < 16; ++i ) {
+        last_round = link.round_trip( 10, UINT64_MAX );
+      }
+      const auto& r = link.receiver();
+      check( r.autotune_stats().rtt_ms == 10, "wrong RTT estimate" );
+      check( r.writer().capacity() == config.recv_capacity_max, "buffer did not grow to the ceiling" );
+      check( last_round > ( 3 << 20 ), "the grown window was not used" );
+      check( r.window_shift() == 7, "shift not chosen for the ceiling" );
+
+      // Going idle shrinks the buffer back; the sender used all of the window it was offered, so it can shrink
+      // all the way at once
+      link.receiver().tick( TCPConfig::RECV_IDLE_DFLT );
+      check( r.writer().capacity() == 64000 and r.autotune_stats().shrinks == 1, "idle buffer did not shrink" );
+      link.receiver().tick( TCPConfig::RECV_IDLE_DFLT );
+      check( r.autotune_stats().shrinks == 1, "shrunk twice" );
+
+      // Traffic resuming grows it again
+      for ( int i = 0; i < 4; ++i ) {
+        link.round_trip( 10, UINT64_MAX );
+      }
+      check( r.writer().capacity() > 64000, "buffer did not grow after idle" );
+    }
+
+    {
+      // Shrinking never takes back window already offered: the right edge never moves backwards, and the buffer
+      // shrinks as the data the sender was allowed to send arrives and is read. (Rounding the window to the scale
+      // can move the edge forward by less than 2^shift on each ACK.)
+      Link link { config, true };
+      for ( int i = 0; i < 16; ++i ) {
+        link.round_trip( 10, UINT64_MAX );
+      }
+      const auto& r = link.receiver();
+      link.receiver().reader().pop( r.reader().bytes_buffered() );
+      uint64_t edge = link.ack();
+      check( edge > r.writer().bytes_pushed() + ( 3 << 20 ), "no large window offered" );
+
+      link.receiver().tick( TCPConfig::RECV_IDLE_DFLT );
+      check( r.autotune_stats().shrinks == 1, "idle buffer did not start shrinking" );
+      for ( int i = 0; r.writer().capacity() > 64000; ++i ) {
+        const uint64_t next = link.ack();
+        check( next >= edge, "right edge moved backwards while shrinking" );
+        edge = next;
+        check( i < 100000, "buffer did not shrink as the offered window was used" );
+        link.send( min<uint64_t>( TCPConfig::MAX_PAYLOAD_SIZE, edge - r.writer().bytes_pushed() ) );
+        link.receiver().reader().pop( r.reader().bytes_buffered() );
+        link.receiver().tick( 1 );
+      }
+      check( link.ack() >= edge, "right edge moved backwards when the shrink finished" );
+      check( r.autotune_stats().shrinks == 1 and r.autotune_stats().grows == 4, "wrong autotune counters" );
+    }
+
+    {
+      // A slow application gains nothing from a bigger buffer, so it keeps the initial one
+      Link link { config, true };
+      for ( int i = 0; i < 16; ++i ) {
+        link.round_trip( 10, 8000 );
+      }
+      check( link.receiver().writer().capacity() == 64000 and link.receiver().autotune_stats().grows == 0,
+             "buffer grew for a slow reader" );
+    }
+
+    {
+      // Without window scaling the window cannot be advertised past 64 KB
+      Link link { config, false };
+      for ( int i = 0; i < 16; ++i ) {
+        link.round_trip( 10, UINT64_MAX );
+      }
+      check( link.receiver().writer().capacity() == UINT16_MAX, "buffer grew past what can be advertised" );
+    }
+
+    {
+      // Auto-tuning is off by default
+      Link link { TCPConfig {}, true };
+      for ( int i = 0; i < 16; ++i ) {
+        link.round_trip( 10, UINT64_MAX );
+      }
+      check( link.receiver().writer().capacity() == 64000, "buffer grew with auto-tuning off" );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#include "tcp_receiver.hh"
+#include "test_utils.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+TCPSenderMessage segment( const uint32_t seqno, string payload, const bool syn = false, const bool fin = false )
+{
+  TCPSenderMessage message;
+  message.seqno = Wrap32 { seqno };
+  message.SYN = syn;
+  message.payload = move( payload );
+  message.FIN = fin;
+  return message;
+}
+
+// Receive a segment and return whether the policy produced an ACK for it
+bool acked( TCPReceiver& r, TCPSenderMessage message )
+{
+  r.receive( move( message ) );
+  return r.maybe_send().has_value();
+}
+
+int main()
+{
+  try {
+    const string full( TCPConfig::MAX_PAYLOAD_SIZE, 'x' );
+
+    {
+      // Every second full-sized segment is acknowledged; a lone one waits for the timer
+      TCPReceiver r { Reassembler { ByteStream { 64000 } }, TCPConfig {} };
+      check( acked( r, segment( 0, "", true ) ), "SYN not acknowledged immediately" );
+      check( not acked( r, segment( 1, full ) ), "first full-sized segment acknowledged" );
+      const auto ack = [&] {
+        r.receive( segment( 1 + full.size(), full ) );
+        return r.maybe_send();
+      }();
+      check( ack.has_value() and ack->ackno == Wrap32 { 1 + 2 * static_cast<uint32_t>( full.size() ) },
+             "second full-sized segment not acknowledged" );
+
+      check( not acked( r, segment( 1 + 2 * full.size(), "abc" ) ), "small segment acknowledged" );
+      r.tick( TCPConfig::ACK_DELAY_DFLT - 1 );
+      check( not r.ack_due() and not r.maybe_send(), "delayed ACK fired early" );
+      r.tick( 1 );
+      check( r.ack_due() and r.maybe_send().has_value(), "delayed ACK did not fire" );
+      r.tick( 1000 );
+      check( not r.maybe_send(), "timer fired with nothing to acknowledge" );
+
+      const auto& stats = r.ack_stats();
+      check( stats.segments == 4 and stats.acks_sent == 3, "wrong ACK counts" );
+      check( stats.immediate_acks == 1 and stats.coalesced_acks == 1 and stats.delayed_acks == 1,
+             "wrong ACK reasons" );
+      check( stats.acks_saved() == 1, "wrong number of ACKs saved" );
+    }
+
+    {
+      // Out-of-order data, the segment filling the gap, duplicates and FIN are acknowledged immediately
+      TCPReceiver r { Reassembler { ByteStream { 64000 } }, TCPConfig {} };
+      check( acked( r, segment( 100, "", true ) ), "SYN" );
+      check( acked( r, segment( 105, "efgh" ) ), "out-of-order segment not acknowledged" );
+      check( acked( r, segment( 101, "abcd" ) ), "gap-filling segment not acknowledged" );
+      check( acked( r, segment( 101, "abcd" ) ), "duplicate segment not acknowledged" );
+      check( acked( r, segment( 109, "ijkl", false, true ) ), "FIN not acknowledged" );
+      check( r.ack_stats().immediate_acks == 5, "wrong immediate ACK count" );
+      // A bare ACK from the peer occupies no sequence numbers and needs no reply
+      check( not acked( r, segment( 114, "" ) ), "empty segment acknowledged" );
+    }
+
+    {
+      // Data past the window edge is acknowledged immediately
+      TCPReceiver r { Reassembler { ByteStream { 4 } }, TCPConfig {} };
+      check( acked( r, segment( 0, "", true ) ), "SYN" );
+      check( acked( r, segment( 1, "abcdef" ) ), "segment overflowing the window not acknowledged" );
+    }
+
+    {
+      // Reading opens the window; an update goes out once the right edge moves far enough
+      TCPReceiver r { Reassembler { ByteStream { 4000 } }, TCPConfig {} };
+      check( acked( r, segment( 0, "", true ) ), "SYN" );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        r.receive( segment( 1 + i * static_cast<uint32_t>( full.size() ), full ) );
+        r.maybe_send();
+      }
+      check( r.send().window_size == 0, "window should be closed" );
+      r.reader().pop( TCPConfig::MAX_PAYLOAD_SIZE - 1 );
+      check( not r.maybe_send(), "window update for less than a segment" );
+      r.reader().pop( 1 );
+      const auto update = r.maybe_send();
+      check( update.has_value() and update->window_size == TCPConfig::MAX_PAYLOAD_SIZE, "no window update" );
+      check( r.ack_stats().window_updates == 1, "wrong window update count" );
+    }
+
+    {
+      // With the policy off, every segment that occupies sequence space is acknowledged
+      TCPConfig config;
+      config.delayed_ack = false;
+      TCPReceiver r { Reassembler { ByteStream { 64000 } }, config };
+      check( acked( r, segment( 0, "", true ) ), "SYN" );
+      for ( uint32_t i = 0; i < 10; ++i ) {
+        check( acked( r, segment( 1 + 10 * i, "0123456789" ) ), "segment not acknowledged" );
+      }
+      check( r.ack_stats().acks_saved() == 0, "ACKs saved with the policy off" );
+    }
+
+    {
+      // ack_every = 4 stretches the ACK interval; the stats add up over a bulk transfer
+      TCPConfig config;
+      config.ack_every = 4;
+      TCPReceiver r { Reassembler { ByteStream { 64000 } }, config };
+      r.receive( segment( 0, "", true ) );
+      r.maybe_send();
+      for ( uint32_t i = 0; i < 400; ++i ) {
+        r.receive( segment( 1 + i * static_cast<uint32_t>( full.size() ), full ) );
+        r.maybe_send();
+        r.reader().pop( full.size() );
+      }
+      const auto& stats = r.ack_stats();
+      check( stats.segments == 401 and stats.coalesced_acks == 100, "wrong coalesced ACK count" );
+      check( stats.acks_sent == stats.immediate_acks + stats.coalesced_acks + stats.delayed_acks
+                                  + stats.window_updates,
+             "ACK reasons do not add up" );
+      check( stats.acks_saved() >= 250, "too few ACKs saved" );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#include "tcp_receiver.hh"
+#include "test_utils.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+TCPSenderMessage segment( const uint32_t seqno, string payload, const bool syn = false, const bool fin = false )
+{
+  TCPSenderMessage message;
+  message.seqno = Wrap32 { seqno };
+  message.SYN = syn;
+  message.payload = move( payload );
+  message.FIN = fin;
+  return message;
+}
+
+// Random reordered, duplicated and truncated segments go to a receiver with the fast path and to one without;
+// every ACK and every delivered byte must be the same.
+void differential_test( const uint32_t isn, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  const string data = random_bytes( 100000, random_seed );
+
+  TCPReceiver fast { Reassembler { ByteStream { 8000 } } };
+  TCPReceiver slow { Reassembler { ByteStream { 8000 } } };
+  slow.set_fast_path( false );
+  string fast_out;
+  string slow_out;
+
+  uniform_int_distribution<int> kind { 0, 9 };
+  uniform_int_distribution<size_t> len { 0, 1500 };
+  uniform_int_distribution<size_t> jitter { 0, 6000 };
+  const auto deliver = [&]( const TCPSenderMessage& message ) {
+    fast.receive( message );
+    slow.receive( message );
+    const auto fast_ack = fast.send();
+    const auto slow_ack = slow.send();
+    check( fast_ack.ackno == slow_ack.ackno and fast_ack.window_size == slow_ack.window_size,
+           "the fast path changed the ACK" );
+  };
+
+  deliver( segment( isn, "", true ) );
+  while ( not fast.reader().is_finished() ) {
+    const size_t pushed = fast.writer().bytes_pushed();
+    // Mostly in order, as bulk transfer is; sometimes ahead, behind, or a retransmission of old data
+    const int k = kind( rd );
+    size_t first = pushed;
+    if ( k == 0 ) {
+      first = min( pushed + jitter( rd ), data.size() );
+    } else if ( k == 1 ) {
+      first = pushed - min( pushed, jitter( rd ) );
+    }
+    const string payload = data.substr( first, len( rd ) );
+    const bool fin = first + payload.size() == data.size();
+    deliver( segment( isn + 1 + static_cast<uint32_t>( first ), payload, false, fin ) );
+    read( fast.reader(), fast_out );
+    read( slow.reader(), slow_out );
+  }
+  check( fast_out == data and slow_out == data, "wrong bytes delivered" );
+  check( fast.fast_path_stats().hits > fast.fast_path_stats().misses,
+         "most in-order segments missed the fast path" );
+  check( slow.fast_path_stats().hits == 0, "the disabled fast path was taken" );
+}
+
+int main()
+{
+  try {
+    {
+      // In-order data after the handshake takes the fast path; SYN and FIN do not
+      TCPReceiver r { Reassembler { ByteStream { 1000 } } };
+      r.receive( segment( 100, "", true ) );
+      r.receive( segment( 101, "abc" ) );
+      r.receive( segment( 104, "def" ) );
+      check( r.fast_path_stats().hits == 2 and r.fast_path_stats().misses == 1, "in-order data missed" );
+      r.receive( segment( 107, "g", false, true ) );
+      check( r.fast_path_stats().misses == 2, "FIN took the fast path" );
+      check( r.send().ackno == Wrap32 { 109 } and r.writer().is_closed(), "FIN not processed" );
+      // A retransmitted FIN lands exactly on the ackno, but the stream is already closed
+      r.receive( segment( 108, "" ) );
+      check( r.fast_path_stats().misses == 3 and not r.reader().has_error(), "segment after FIN" );
+      string out;
+      read( r.reader(), out );
+      check( out == "abcdefg", "wrong bytes delivered" );
+    }
+
+    {
+      // An out-of-order segment misses; the one filling the gap hits and delivers both
+      TCPReceiver r { Reassembler { ByteStream { 1000 } } };
+      r.receive( segment( 0, "", true ) );
+      r.receive( segment( 4, "def" ) );
+      check( r.fast_path_stats().misses == 2 and r.reassembler().bytes_pending() == 3, "out-of-order segment" );
+      r.receive( segment( 1, "abc" ) );
+      check( r.fast_path_stats().hits == 1 and r.writer().bytes_pushed() == 6, "gap-filling segment" );
+      check( r.send().ackno == Wrap32 { 7 }, "wrong ackno" );
+    }
+
+    {
+      // Sequence numbers wrapping past 2^32 keep hitting
+      TCPReceiver r { Reassembler { ByteStream { 1000 } } };
+      const uint32_t isn = UINT32_MAX - 5;
+      r.receive( segment( isn, "", true ) );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        r.receive( segment( isn + 1 + 3 * i, "xyz" ) );
+      }
+      check( r.fast_path_stats().hits == 4 and r.writer().bytes_pushed() == 12, "missed across the wrap" );
+      check( r.send().ackno == Wrap32 { isn + 13 }, "wrong ackno across the wrap" );
+    }
+
+    {
+      // RST is never predicted
+      TCPReceiver r { Reassembler { ByteStream { 1000 } } };
+      r.receive( segment( 0, "", true ) );
+      TCPSenderMessage rst = segment( 1, "" );
+      rst.RST = true;
+      r.receive( rst );
+      check( r.send().RST and r.fast_path_stats().hits == 0, "RST took the fast path" );
+    }
+
+    differential_test( 0, 1 );
+    differential_test( UINT32_MAX - 50000, 2 );
+    differential_test( 123456789, 3 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+#include "tcp_receiver.hh"
+#include "test_utils.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+struct Result
+{
+  double gigabits_per_second;
+  double ns_per_segment;
+  TCPReceiver::FastPathStats stats;
+  TCPReceiver::AckStats acks;
+};
+
+// Bulk in-order transfer: every segment arrives at the ackno, the ACK policy decides whether to acknowledge it,
+// and the application reads after each one
+Result run( vector<TCPSenderMessage> segments, const size_t stream_len, const bool fast_path, string& output )
+{
+  TCPReceiver receiver { Reassembler { ByteStream { 64000 } }, TCPConfig {} };
+  receiver.set_fast_path( fast_path );
+  output.clear();
+
+  const auto start_time = steady_clock::now();
+  for ( auto& segment : segments ) {
+    receiver.receive( move( segment ) );
+    receiver.maybe_send();
+    read( receiver.reader(), output );
+  }
+  const auto elapsed = duration_cast<duration<double>>( steady_clock::now() - start_time );
+
+  if ( not receiver.reader().is_finished() or output.size() != stream_len ) {
+    throw runtime_error( "TCPReceiver did not deliver the whole stream" );
+  }
+  return { 8 * static_cast<double>( stream_len ) / elapsed.count() / 1e9,
+           elapsed.count() * 1e9 / static_cast<double>( segments.size() ),
+           receiver.fast_path_stats(),
+           receiver.ack_stats() };
+}
+
+} // namespace
+
+void speed_test( const size_t num_segments, const size_t segment_size, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  const string data = random_bytes( num_segments * segment_size, random_seed );
+
+  // The payloads are copied here, before timing
+  const Wrap32 isn { uniform_int_distribution<uint32_t> {}( rd ) };
+  vector<TCPSenderMessage> segments;
+  segments.push_back( { isn, true, {}, false, false } );
+  for ( size_t i = 0; i < data.size(); i += segment_size ) {
+    segments.push_back( { isn + static_cast<uint32_t>( 1 + i ),
+                          false,
+                          data.substr( i, segment_size ),
+                          i + segment_size >= data.size(),
+                          false } );
+  }
+
+  string output( data.size(), 0 );
+  const Result general = run( segments, data.size(), false, output );
+  const Result fast = run( segments, data.size(), true, output );
+  if ( output != data ) {
+    throw runtime_error( "Mismatch between data sent and received" );
+  }
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "TCPReceiver bulk in-order transfer (" << segment_size << "-byte segments): general path " << fixed
+       << setprecision( 2 ) << general.gigabits_per_second << " Gbit/s (" << setprecision( 0 )
+       << general.ns_per_segment << " ns/segment), header prediction " << setprecision( 2 )
+       << fast.gigabits_per_second << " Gbit/s (" << setprecision( 0 ) << fast.ns_per_segment
+       << " ns/segment), speedup " << setprecision( 2 ) << general.ns_per_segment / fast.ns_per_segment << "x\n";
+  cout << "Fast path hits: " << fast.stats.hits << ", misses: " << fast.stats.misses << "\n";
+  cout << "ACKs sent: " << fast.acks.acks_sent << " for " << fast.acks.segments << " segments ("
+       << fast.acks.acks_saved() << " saved by the delayed-ACK policy)\n";
+
+  debug_output << "  TCPReceiver throughput: " << fixed << setprecision( 2 ) << fast.gigabits_per_second
+               << " Gbit/s\n";
+
+  if ( fast.gigabits_per_second < 0.1 ) {
+    throw runtime_error( "TCPReceiver did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+int main()
+{
+  try {
+    speed_test( 100000, 1000, 1370 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
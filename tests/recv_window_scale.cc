@@ -0,0 +1,151 @@
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      const size_t cap = 10'000'000;
+      const uint32_t isn = 5;
+      TCPReceiverTestHarness test { "scaled window at 10M", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 7 ) );
+      // The first ACK rides on our SYN-ACK, whose window is never scaled
+      test.execute( ExpectWindowShift { 0 } );
+      test.execute( ExpectWindow { UINT16_MAX } );
+      // Scaling takes effect once the peer's first non-SYN segment completes the handshake
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ) );
+      test.execute( ExpectWindowShift { 8 } );
+      test.execute( ExpectWindow { cap >> 8 } );
+      test.execute( ExpectScaledWindow { ( cap >> 8 ) << 8 } );
+    }
+
+    {
+      const size_t cap = 10'000'000;
+      const uint32_t isn = 5;
+      TCPReceiverTestHarness test { "no scaling when the peer does not offer it", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindowShift { 0 } );
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+
+    {
+      const size_t cap = 4000;
+      const uint32_t isn = 5;
+      TCPReceiverTestHarness test { "small capacity needs no shift", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 3 ) );
+      test.execute( ExpectWindowShift { 0 } );
+      test.execute( ExpectWindow { cap } );
+    }
+
+    {
+      const size_t cap = 1 << 20;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "scaled window rounds down as it shrinks", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 2 ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ) );
+      test.execute( ExpectWindowShift { 5 } );
+      test.execute( ExpectWindow { cap >> 5 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 100, 'x' ) ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 101 } } );
+      test.execute( ExpectWindow { ( cap - 100 ) >> 5 } );
+      test.execute( ExpectScaledWindow { ( ( cap - 100 ) >> 5 ) << 5 } );
+      test.execute( ReadAll { string( 100, 'x' ) } );
+      test.execute( ExpectScaledWindow { cap } );
+    }
+
+    {
+      // The whole multi-megabyte window is usable: data far past 64 KB from the ackno is accepted
+      const size_t cap = 8 << 20;
+      const uint32_t isn = 1000;
+      const size_t segment_size = 256 << 10;
+      TCPReceiverTestHarness test { "multi-megabyte window", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 14 ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ) );
+      test.execute( ExpectWindowShift { 8 } );
+      for ( size_t i = segment_size; i < cap; i += segment_size ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 1 + i ).with_data( string( segment_size, 'b' ) ) );
+      }
+      test.execute( BytesPending { cap - segment_size } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( segment_size, 'a' ) ) );
+      test.execute( BytesPushed { cap } );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 + static_cast<uint32_t>( cap ) } } );
+      test.execute( ExpectWindow { 0 } );
+    }
+
+    {
+      // Passive open: the ACK that rides on our SYN-ACK is unscaled, every ACK after it is scaled
+      TCPReceiver receiver { Reassembler { ByteStream { 1 << 20 } }, TCPConfig {} };
+      TCPSenderMessage syn;
+      syn.seqno = Wrap32 { 7 };
+      syn.SYN = true;
+      syn.window_scale = 3;
+      receiver.receive( syn );
+      const TCPReceiverMessage syn_ack = receiver.send_ack();
+      const TCPReceiverMessage next = receiver.send_ack();
+      if ( syn_ack.window_shift != 0 or syn_ack.window_size != UINT16_MAX or next.window_shift != 5
+           or next.window() != ( 1 << 20 ) ) {
+        throw runtime_error( "passive open: SYN-ACK window scaled, or later ACK not scaled" );
+      }
+    }
+
+    {
+      // Active open: our SYN went out first, so the ACK of the peer's SYN-ACK is already scaled
+      TCPReceiver receiver { Reassembler { ByteStream { 1 << 20 } }, TCPConfig {} };
+      const TCPReceiverMessage our_syn = receiver.send_ack();
+      if ( our_syn.ackno or our_syn.window_shift != 0 or our_syn.window_size != UINT16_MAX ) {
+        throw runtime_error( "active open: window on our SYN was scaled" );
+      }
+      TCPSenderMessage syn_ack;
+      syn_ack.seqno = Wrap32 { 7 };
+      syn_ack.SYN = true;
+      syn_ack.window_scale = 3;
+      receiver.receive( syn_ack );
+      const auto ack = receiver.maybe_send();
+      if ( not ack or ack->ackno != Wrap32 { 8 } or ack->window_shift != 5 or ack->window() != ( 1 << 20 ) ) {
+        throw runtime_error( "active open: ACK of the SYN-ACK was not scaled" );
+      }
+    }
+
+    {
+      // The peer's shift is capped at 14
+      TCPReceiver receiver { Reassembler { ByteStream { 1 << 20 } }, TCPConfig {} };
+      TCPSenderMessage syn;
+      syn.SYN = true;
+      syn.window_scale = 20;
+      receiver.receive( syn );
+      if ( receiver.peer_window_shift() != 14 or receiver.window_shift() != 5 ) {
+        throw runtime_error( "peer's window shift not capped at 14" );
+      }
+    }
+
+    {
+      // Scaling can be turned off in TCPConfig; then the peer's windows are not scaled either
+      TCPConfig config;
+      config.window_scaling = false;
+      TCPReceiver receiver { Reassembler { ByteStream { 1 << 20 } }, config };
+      TCPSenderMessage syn;
+      syn.SYN = true;
+      syn.window_scale = 7;
+      receiver.receive( syn );
+      TCPSenderMessage ack;
+      ack.seqno = syn.seqno + 1;
+      receiver.receive( ack );
+      if ( receiver.offered_window_shift() or receiver.window_shift() != 0
+           or receiver.send().window_size != UINT16_MAX or receiver.peer_window_shift() != nullopt ) {
+        throw runtime_error( "window scaling not disabled by TCPConfig" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
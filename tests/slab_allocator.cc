@@ -0,0 +1,67 @@
+#include "slab_allocator.hh"
+#include "test_utils.hh"
+
+#include <exception>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int main()
+{
+  try {
+    const auto before = SlabPool::stats();
+
+    // a freed block of one size class comes back for the next request of that class
+    void* a = SlabPool::allocate( 100 );
+    SlabPool::deallocate( a, 100 );
+    void* b = SlabPool::allocate( 120 );
+    check( a == b, "SlabPool did not reuse a freed block of the same size class" );
+
+    void* large = SlabPool::allocate( SlabPool::kMaxBlockSize + 1 );
+    auto during = SlabPool::stats();
+    check( during.outstanding_blocks == before.outstanding_blocks + 2, "wrong outstanding block count" );
+    check( during.large_allocations == before.large_allocations + 1, "large allocation not counted" );
+    check( during.allocations == before.allocations + 3, "wrong allocation count" );
+
+    SlabPool::deallocate( b, 120 );
+    SlabPool::deallocate( large, SlabPool::kMaxBlockSize + 1 );
+    check( SlabPool::stats().outstanding_blocks == before.outstanding_blocks, "blocks leaked" );
+
+    // containers work through SlabAllocator
+    {
+      set<int, less<int>, SlabAllocator<int>> numbers;
+      vector<char, SlabAllocator<char>> bytes( 5000, 'x' );
+      for ( int i = 0; i < 1000; ++i ) {
+        numbers.insert( i );
+      }
+      check( numbers.size() == 1000 and bytes.back() == 'x', "container contents wrong" );
+      check( SlabPool::stats().outstanding_blocks == before.outstanding_blocks + 1001, "wrong container count" );
+    }
+    check( SlabPool::stats().outstanding_blocks == before.outstanding_blocks, "container blocks leaked" );
+
+    // blocks may be freed on a different thread, and exited threads keep their counts
+    vector<void*> blocks;
+    thread producer { [&] {
+      for ( int i = 0; i < 500; ++i ) {
+        blocks.push_back( SlabPool::allocate( 1500 ) );
+      }
+    } };
+    producer.join();
+    check( SlabPool::stats().outstanding_blocks == before.outstanding_blocks + 500, "thread count lost" );
+    for ( void* block : blocks ) {
+      SlabPool::deallocate( block, 1500 );
+    }
+    check( SlabPool::stats().outstanding_blocks == before.outstanding_blocks, "cross-thread frees lost" );
+    check( SlabPool::stats().hit_rate() > 0, "no thread cache hits recorded" );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+#include "slab_allocator.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+// Churn a working set of live blocks with mixed segment-sized allocations, as a receiver would.
+template<typename Alloc>
+double churn( const vector<size_t>& sizes, const size_t live, const size_t rounds )
+{
+  Alloc alloc;
+  vector<pair<char*, size_t>> slots( live, { nullptr, 0 } );
+
+  const auto start_time = steady_clock::now();
+  for ( size_t round = 0; round < rounds; ++round ) {
+    for ( size_t i = 0; i < sizes.size(); ++i ) {
+      auto& slot = slots[i % live];
+      if ( slot.first ) {
+        alloc.deallocate( slot.first, slot.second );
+      }
+      slot = { alloc.allocate( sizes[i] ), sizes[i] };
+      slot.first[0] = static_cast<char>( i );
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  for ( auto& slot : slots ) {
+    if ( slot.first ) {
+      alloc.deallocate( slot.first, slot.second );
+    }
+  }
+
+  const auto ops = static_cast<double>( sizes.size() * rounds );
+  return duration_cast<duration<double, nano>>( stop_time - start_time ).count() / ops;
+}
+
+// Insert and erase out-of-order segments the way the Reassembler's set does.
+template<typename Set>
+double set_churn( const vector<uint64_t>& keys )
+{
+  Set segments;
+  const auto start_time = steady_clock::now();
+  for ( const auto key : keys ) {
+    segments.insert( key );
+    if ( segments.size() > 64 ) {
+      segments.erase( segments.begin() );
+    }
+  }
+  const auto stop_time = steady_clock::now();
+  const auto elapsed = duration_cast<duration<double, nano>>( stop_time - start_time );
+  return elapsed.count() / static_cast<double>( keys.size() );
+}
+
+} // namespace
+
+void speed_test( const size_t num_ops, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<size_t> size_dist { 1, 1500 };
+  vector<size_t> sizes( num_ops );
+  for ( auto& x : sizes ) {
+    x = size_dist( rd );
+  }
+  uniform_int_distribution<uint64_t> key_dist;
+  vector<uint64_t> keys( num_ops );
+  for ( auto& x : keys ) {
+    x = key_dist( rd );
+  }
+
+  const auto before = SlabPool::stats();
+  const double malloc_ns = churn<allocator<char>>( sizes, 256, 10 );
+  const double slab_ns = churn<SlabAllocator<char>>( sizes, 256, 10 );
+  const double malloc_set_ns = set_churn<set<uint64_t>>( keys );
+  const double slab_set_ns = set_churn<set<uint64_t, less<uint64_t>, SlabAllocator<uint64_t>>>( keys );
+  const auto after = SlabPool::stats();
+
+  const auto allocations = after.allocations - before.allocations;
+  const auto hits = after.thread_cache_hits - before.thread_cache_hits;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << fixed << setprecision( 2 ) << "Buffer churn: malloc " << malloc_ns << " ns/op, slab " << slab_ns
+       << " ns/op. Set node churn: malloc " << malloc_set_ns << " ns/op, slab " << slab_set_ns << " ns/op. "
+       << "Slab thread-cache hit rate " << 100.0 * static_cast<double>( hits ) / static_cast<double>( allocations )
+       << "%, " << after.slabs << " slabs, " << after.outstanding_blocks << " blocks outstanding.\n";
+
+  debug_output << "             SlabPool: " << fixed << setprecision( 2 ) << slab_ns << " ns/op (malloc "
+               << malloc_ns << " ns/op)\n";
+
+  if ( after.outstanding_blocks != before.outstanding_blocks ) {
+    throw runtime_error( "SlabPool benchmark leaked blocks" );
+  }
+}
+
+void program_body()
+{
+  speed_test( 1000000, 8128 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
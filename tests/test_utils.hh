@@ -0,0 +1,109 @@
+#pragma once
+
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Helpers for the tests that check conditions directly instead of through a TestHarness
+
+inline void check( const bool condition, const std::string& what )
+{
+  if ( not condition ) {
+    throw std::runtime_error( what );
+  }
+}
+
+// `len` bytes of 'a' through 'z' repeating, so the byte at any stream index is easy to predict
+inline std::string pattern_data( const size_t len )
+{
+  std::string ret( len, 0 );
+  for ( size_t i = 0; i < len; ++i ) {
+    ret[i] = static_cast<char>( 'a' + i % 26 );
+  }
+  return ret;
+}
+
+// `len` random bytes, the same for the same seed
+inline std::string random_bytes( const size_t len, const size_t random_seed )
+{
+  std::default_random_engine rd { random_seed };
+  std::uniform_int_distribution<char> ud;
+  std::string ret;
+  ret.reserve( len );
+  for ( size_t i = 0; i < len; ++i ) {
+    ret += ud( rd );
+  }
+  return ret;
+}
+
+/*
+ * Feed `tested` and `reference` the same random, overlapping substrings of a random stream of `stream_len` bytes,
+ * reading from both at random, and check that both deliver the whole stream. The substrings start up to 1.5x
+ * the capacity ahead of the write position, some reaching back before it, and are up to half the capacity long.
+ *
+ * With `max_batch` = 1 every substring goes to both through insert(). Otherwise each round hands up to
+ * `max_batch` of them to `tested` through insert_many() and to `reference` one insert() at a time.
+ * With `compare_pending`, the two must also agree on bytes pushed, bytes pending and being finished after every
+ * round (the Segments engine may keep different pieces of overlapping substrings inside one batch).
+ */
+inline void differential_check( Reassembler tested, // NOLINT(*-function-cognitive-complexity)
+                                Reassembler reference,
+                                const size_t stream_len,  // NOLINT(bugprone-easily-swappable-parameters)
+                                const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                                const size_t max_batch = 1,
+                                const bool compare_pending = true )
+{
+  const std::string data = random_bytes( stream_len, random_seed );
+  const size_t capacity = reference.writer().capacity();
+  std::default_random_engine rd { random_seed };
+  std::uniform_int_distribution<size_t> len_dist { 0, capacity / 2 + 1 };
+  std::uniform_int_distribution<size_t> ahead_dist { 0, capacity + capacity / 2 };
+  std::uniform_int_distribution<size_t> batch_dist { 1, max_batch };
+  std::uniform_int_distribution<int> read_dist { 0, 3 };
+
+  std::string tested_out;
+  std::string reference_out;
+  std::vector<Reassembler::Substring> batch;
+  while ( not tested.reader().is_finished() or not reference.reader().is_finished() ) {
+    batch.clear();
+    const size_t pushed = std::min( tested.writer().bytes_pushed(), reference.writer().bytes_pushed() );
+    for ( size_t i = batch_dist( rd ); i > 0; --i ) {
+      const size_t start = std::min( pushed + ahead_dist( rd ), stream_len );
+      const size_t first_index = start - std::min( start, ahead_dist( rd ) / 4 );
+      const size_t size = std::min( len_dist( rd ), stream_len - first_index );
+      batch.push_back( { first_index,
+                         BufferSlice { data.substr( first_index, size ) },
+                         first_index + size == stream_len } );
+    }
+
+    for ( const auto& sub : batch ) {
+      reference.insert( sub.first_index, sub.data, sub.is_last_substring );
+    }
+    if ( max_batch == 1 ) {
+      tested.insert( batch[0].first_index, std::move( batch[0].data ), batch[0].is_last_substring );
+    } else {
+      tested.insert_many( batch );
+    }
+
+    if ( compare_pending
+         and ( tested.bytes_pending() != reference.bytes_pending()
+               or tested.writer().bytes_pushed() != reference.writer().bytes_pushed()
+               or tested.reader().is_finished() != reference.reader().is_finished() ) ) {
+      throw std::runtime_error( "Reassembler diverged from the reference with seed " + std::to_string( random_seed )
+                                + " after " + std::to_string( reference.writer().bytes_pushed() )
+                                + " bytes pushed" );
+    }
+    if ( read_dist( rd ) == 0 ) {
+      read( tested.reader(), tested_out );
+      read( reference.reader(), reference_out );
+    }
+  }
+  read( tested.reader(), tested_out );
+  read( reference.reader(), reference_out );
+  check( tested_out == data and reference_out == data, "Reassembled stream does not match the original data" );
+}
@@ -0,0 +1,119 @@
+#include "random.hh"
+#include "test_should_be.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// wrap() and unwrap() are evaluated by the compiler here
+static_assert( Wrap32::wrap( 3 * ( 1UL << 32 ), Wrap32 { 0 } ) == Wrap32 { 0 } );
+static_assert( Wrap32::wrap( 3 * ( 1UL << 32 ) + 17, Wrap32 { 15 } ) == Wrap32 { 32 } );
+static_assert( Wrap32::wrap( 7 * ( 1UL << 32 ) - 2, Wrap32 { 15 } ) == Wrap32 { 13 } );
+
+static_assert( Wrap32 { 1 }.unwrap( Wrap32 { 0 }, 0 ) == 1 );
+static_assert( Wrap32 { 1 }.unwrap( Wrap32 { 0 }, UINT32_MAX ) == ( 1UL << 32 ) + 1 );
+static_assert( Wrap32 { UINT32_MAX - 1 }.unwrap( Wrap32 { 0 }, 3 * ( 1UL << 32 ) ) == 3 * ( 1UL << 32 ) - 2 );
+static_assert( Wrap32 { UINT32_MAX }.unwrap( Wrap32 { 10 }, 3 * ( 1UL << 32 ) ) == 3 * ( 1UL << 32 ) - 11 );
+static_assert( Wrap32 { 16 }.unwrap( Wrap32 { 16 }, 3 * ( 1UL << 32 ) ) == 3 * ( 1UL << 32 ) );
+// Going back from a checkpoint near 0 would be negative, so the seqno is the one ahead
+static_assert( Wrap32 { UINT32_MAX }.unwrap( Wrap32 { 0 }, 0 ) == UINT32_MAX );
+static_assert( Wrap32 { 1U << 31 }.unwrap( Wrap32 { 0 }, 0 ) == 1UL << 31 );
+// A tie 2^31 away on either side goes back when it can
+static_assert( Wrap32 { 0 }.unwrap( Wrap32 { 0 }, 3 * ( 1UL << 31 ) ) == 1UL << 32 );
+// Checkpoints close to 2^64
+static_assert( Wrap32 { 5 }.unwrap( Wrap32 { 0 }, UINT64_MAX - 10 ) == UINT64_MAX - ( 1UL << 32 ) + 6 );
+static_assert( Wrap32 { UINT32_MAX - 3 }.unwrap( Wrap32 { 0 }, UINT64_MAX - 10 ) == UINT64_MAX - 3 );
+
+// RFC 1982 serial number comparison
+static_assert( Wrap32 { 1 } < Wrap32 { 2 } and not( Wrap32 { 2 } < Wrap32 { 1 } ) );
+static_assert( Wrap32 { UINT32_MAX } < Wrap32 { 0 } and Wrap32 { 0 } > Wrap32 { UINT32_MAX } );
+static_assert( Wrap32 { UINT32_MAX - 5 } < Wrap32 { 100 } );
+static_assert( not( Wrap32 { 7 } < Wrap32 { 7 } ) and not( Wrap32 { 7 } > Wrap32 { 7 } ) );
+static_assert( Wrap32 { 7 } <= Wrap32 { 7 } and Wrap32 { 7 } >= Wrap32 { 7 } );
+static_assert( Wrap32 { 0 } < Wrap32 { INT32_MAX } and Wrap32 { 0 } > Wrap32 { 1U << 31 | 1 } );
+// Exactly 2^31 apart: neither is before the other
+static_assert( not( Wrap32 { 0 } < Wrap32 { 1U << 31 } ) and not( Wrap32 { 1U << 31 } < Wrap32 { 0 } ) );
+static_assert( not( Wrap32 { 0 } <= Wrap32 { 1U << 31 } ) and not( Wrap32 { 0 } >= Wrap32 { 1U << 31 } ) );
+
+namespace {
+
+// The straightforward definition the branch-free unwrap must agree with
+uint64_t reference_unwrap( const uint32_t raw, const uint32_t zero_point, const uint64_t checkpoint )
+{
+  const uint64_t low = static_cast<uint32_t>( raw - zero_point );
+  const uint64_t base = ( checkpoint & ~uint64_t { UINT32_MAX } ) | low;
+  uint64_t best = base;
+  for ( const int64_t shift : { -1L, 1L } ) {
+    const uint64_t candidate = base + static_cast<uint64_t>( shift << 32 );
+    if ( shift < 0 and base < ( 1UL << 32 ) ) {
+      continue;
+    }
+    if ( shift > 0 and candidate < base ) {
+      continue;
+    }
+    const auto dist = []( uint64_t a, uint64_t b ) { return a > b ? a - b : b - a; };
+    if ( dist( candidate, checkpoint ) < dist( best, checkpoint )
+         or ( dist( candidate, checkpoint ) == dist( best, checkpoint ) and candidate < best ) ) {
+      best = candidate;
+    }
+  }
+  return best;
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    uniform_int_distribution<uint32_t> dist32;
+    uniform_int_distribution<uint64_t> dist64;
+    uniform_int_distribution<uint64_t> near_zero { 0, 3UL << 32 };
+
+    // Scalar unwrap against the reference, over the whole range of checkpoints
+    for ( size_t i = 0; i < 1'000'000; ++i ) {
+      const uint32_t raw = dist32( rd );
+      const uint32_t zero_point = dist32( rd );
+      const uint64_t checkpoint = i % 2 ? dist64( rd ) : near_zero( rd );
+      test_should_be( Wrap32 { raw }.unwrap( Wrap32 { zero_point }, checkpoint ),
+                      reference_unwrap( raw, zero_point, checkpoint ) );
+    }
+
+    // Batch unwrap matches the scalar one, including the tail that does not fill a block
+    for ( const size_t n : { 0UL, 1UL, 7UL, 8UL, 9UL, 1000UL, 1003UL } ) {
+      const Wrap32 zero_point { dist32( rd ) };
+      const uint64_t checkpoint = near_zero( rd );
+      vector<Wrap32> seqnos;
+      for ( size_t i = 0; i < n; ++i ) {
+        seqnos.emplace_back( dist32( rd ) );
+      }
+      vector<uint64_t> out( n, UINT64_MAX );
+      Wrap32::unwrap( seqnos, zero_point, checkpoint, out );
+      for ( size_t i = 0; i < n; ++i ) {
+        test_should_be( out[i], seqnos[i].unwrap( zero_point, checkpoint ) );
+      }
+    }
+
+    // Serial number comparison against its definition in RFC 1982
+    for ( size_t i = 0; i < 1'000'000; ++i ) {
+      const uint32_t a = dist32( rd );
+      const uint32_t b = i % 2 ? dist32( rd ) : a + dist32( rd ) % 64 - 32;
+      const bool less = ( a < b and b - a < ( 1U << 31 ) ) or ( a > b and a - b > ( 1U << 31 ) );
+      test_should_be( Wrap32 { a } < Wrap32 { b }, less );
+      test_should_be( Wrap32 { b } > Wrap32 { a }, less );
+      test_should_be( Wrap32 { a } <= Wrap32 { b }, less or a == b );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+#include "wrapping_integers.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+template<typename F>
+double ns_per_unwrap( const size_t rounds, const size_t count, F&& f )
+{
+  const auto start_time = steady_clock::now();
+  for ( size_t i = 0; i < rounds; ++i ) {
+    f();
+  }
+  const auto elapsed = duration_cast<duration<double, nano>>( steady_clock::now() - start_time );
+  return elapsed.count() / static_cast<double>( rounds * count );
+}
+
+} // namespace
+
+void speed_test( const size_t count, const size_t rounds, const size_t random_seed )
+{
+  // Seqnos of a stream a few times past 2^32, as a receiver sees them: mostly in order, with some jitter
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<uint32_t> jitter { 0, 64 * 1024 };
+  const Wrap32 zero_point { uniform_int_distribution<uint32_t> {}( rd ) };
+  const uint64_t base = ( uint64_t { 3 } << 32 ) - count * 500;
+  vector<Wrap32> seqnos;
+  for ( size_t i = 0; i < count; ++i ) {
+    seqnos.push_back( Wrap32::wrap( base + i * 1000 + jitter( rd ), zero_point ) );
+  }
+  const uint64_t checkpoint = base + count * 500;
+  vector<uint64_t> scalar_out( count );
+  vector<uint64_t> batch_out( count );
+  uint64_t chained = 0;
+
+  // One at a time with a fixed checkpoint, as a loop over segments would
+  const double scalar = ns_per_unwrap( rounds, count, [&] {
+    for ( size_t i = 0; i < count; ++i ) {
+      scalar_out[i] = seqnos[i].unwrap( zero_point, checkpoint );
+    }
+  } );
+  // Each checkpoint is the previous result, as a receiver's ackno is: the latency of one unwrap
+  const double dependent = ns_per_unwrap( rounds, count, [&] {
+    uint64_t last = base;
+    for ( size_t i = 0; i < count; ++i ) {
+      last = seqnos[i].unwrap( zero_point, last );
+    }
+    chained += last;
+  } );
+  const double batch
+    = ns_per_unwrap( rounds, count, [&] { Wrap32::unwrap( seqnos, zero_point, checkpoint, batch_out ); } );
+
+  if ( batch_out != scalar_out or chained == 0 ) {
+    throw runtime_error( "batch unwrap disagrees with scalar unwrap" );
+  }
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Wrap32::unwrap over " << count << " seqnos: " << fixed << setprecision( 3 ) << scalar
+       << " ns/unwrap one at a time, " << dependent << " ns/unwrap chained on the previous result, " << batch
+       << " ns/unwrap batched (" << setprecision( 2 ) << scalar / batch << "x)\n";
+
+  debug_output << "  Wrap32::unwrap: " << fixed << setprecision( 3 ) << batch << " ns/unwrap batched\n";
+
+  if ( batch > 20 ) {
+    throw runtime_error( "batch unwrap did not meet maximum time of 20 ns/unwrap." );
+  }
+}
+
+int main()
+{
+  try {
+    speed_test( 4096, 20000, 1370 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
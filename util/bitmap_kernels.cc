@@ -0,0 +1,141 @@
+#include "bitmap_kernels.hh"
+
+#include <bit>
+
+// _mm_popcnt_u64 and _mm256_extract_epi64 exist only on x86-64; 32-bit x86 uses the portable kernels
+#if defined( __x86_64__ )
+#include <immintrin.h>
+#define MINNOW_X86_KERNELS 1
+#endif
+
+using namespace std;
+
+namespace {
+
+size_t scalar_find_word( const uint64_t* words, size_t n, uint64_t pattern )
+{
+  for ( size_t i = 0; i < n; ++i ) {
+    if ( words[i] != pattern ) {
+      return i;
+    }
+  }
+  return n;
+}
+
+size_t scalar_popcount( const uint64_t* words, size_t n )
+{
+  size_t total = 0;
+  for ( size_t i = 0; i < n; ++i ) {
+    total += static_cast<size_t>( popcount( words[i] ) );
+  }
+  return total;
+}
+
+#ifdef MINNOW_X86_KERNELS
+
+// Two words per compare; the hardware popcnt instruction for counting
+__attribute__( ( target( "sse4.2,popcnt" ) ) ) size_t sse42_find_word( const uint64_t* words,
+                                                                        size_t n,
+                                                                        uint64_t pattern )
+{
+  const __m128i want = _mm_set1_epi64x( static_cast<int64_t>( pattern ) );
+  size_t i = 0;
+  for ( ; i + 2 <= n; i += 2 ) {
+    const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( words + i ) ); // NOLINT(*-cast)
+    if ( _mm_movemask_epi8( _mm_cmpeq_epi64( v, want ) ) != 0xFFFF ) {
+      break;
+    }
+  }
+  return i + scalar_find_word( words + i, n - i, pattern );
+}
+
+__attribute__( ( target( "sse4.2,popcnt" ) ) ) size_t sse42_popcount( const uint64_t* words, size_t n )
+{
+  // Four independent accumulators keep several popcnt instructions in flight
+  uint64_t a = 0;
+  uint64_t b = 0;
+  uint64_t c = 0;
+  uint64_t d = 0;
+  size_t i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    a += static_cast<uint64_t>( _mm_popcnt_u64( words[i] ) );
+    b += static_cast<uint64_t>( _mm_popcnt_u64( words[i + 1] ) );
+    c += static_cast<uint64_t>( _mm_popcnt_u64( words[i + 2] ) );
+    d += static_cast<uint64_t>( _mm_popcnt_u64( words[i + 3] ) );
+  }
+  for ( ; i < n; ++i ) {
+    a += static_cast<uint64_t>( _mm_popcnt_u64( words[i] ) );
+  }
+  return a + b + c + d;
+}
+
+// Eight words (512 bits) per iteration, as two 256-bit compares
+__attribute__( ( target( "avx2" ) ) ) size_t avx2_find_word( const uint64_t* words, size_t n, uint64_t pattern )
+{
+  const __m256i want = _mm256_set1_epi64x( static_cast<int64_t>( pattern ) );
+  size_t i = 0;
+  for ( ; i + 8 <= n; i += 8 ) {
+    const __m256i lo = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( words + i ) );     // NOLINT(*-cast)
+    const __m256i hi = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( words + i + 4 ) ); // NOLINT(*-cast)
+    const __m256i same = _mm256_and_si256( _mm256_cmpeq_epi64( lo, want ), _mm256_cmpeq_epi64( hi, want ) );
+    if ( _mm256_movemask_epi8( same ) != -1 ) {
+      break;
+    }
+  }
+  return i + scalar_find_word( words + i, n - i, pattern );
+}
+
+// Nibble-lookup popcount: a byte shuffle counts each nibble, and SAD sums the bytes into four 64-bit lanes
+__attribute__( ( target( "avx2" ) ) ) size_t avx2_popcount( const uint64_t* words, size_t n )
+{
+  const __m256i lookup = _mm256_setr_epi8(
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+  const __m256i low_nibbles = _mm256_set1_epi8( 0x0F );
+  __m256i total = _mm256_setzero_si256();
+  size_t i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( words + i ) ); // NOLINT(*-cast)
+    const __m256i lo = _mm256_shuffle_epi8( lookup, _mm256_and_si256( v, low_nibbles ) );
+    const __m256i hi = _mm256_shuffle_epi8( lookup, _mm256_and_si256( _mm256_srli_epi16( v, 4 ), low_nibbles ) );
+    total = _mm256_add_epi64( total, _mm256_sad_epu8( _mm256_add_epi8( lo, hi ), _mm256_setzero_si256() ) );
+  }
+  const auto sum = static_cast<size_t>( _mm256_extract_epi64( total, 0 ) + _mm256_extract_epi64( total, 1 )
+                                        + _mm256_extract_epi64( total, 2 ) + _mm256_extract_epi64( total, 3 ) );
+  return sum + scalar_popcount( words + i, n - i );
+}
+
+#endif
+
+} // namespace
+
+const BitmapKernels& BitmapKernels::scalar()
+{
+  static const BitmapKernels kernels { "scalar", scalar_find_word, scalar_popcount };
+  return kernels;
+}
+
+const vector<const BitmapKernels*>& BitmapKernels::available()
+{
+  static const vector<const BitmapKernels*> sets = [] {
+    vector<const BitmapKernels*> ret { &scalar() };
+#ifdef MINNOW_X86_KERNELS
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "sse4.2" ) && __builtin_cpu_supports( "popcnt" ) ) {
+      static const BitmapKernels sse42 { "sse4.2", sse42_find_word, sse42_popcount };
+      ret.push_back( &sse42 );
+    }
+    if ( __builtin_cpu_supports( "avx2" ) ) {
+      static const BitmapKernels avx2 { "avx2", avx2_find_word, avx2_popcount };
+      ret.push_back( &avx2 );
+    }
+#endif
+    return ret;
+  }();
+  return sets;
+}
+
+const BitmapKernels& BitmapKernels::best()
+{
+  static const BitmapKernels& kernels = *available().back();
+  return kernels;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! \brief Word-array scanning kernels behind PresenceBitmap, in scalar and SIMD versions.
+//!
+//! `find_word` locates the first word that is not entirely `pattern` (all zeros or all ones), which is how a
+//! bitmap finds the next hole or the end of a run without looking at each bit. `popcount` counts set bits.
+//! The SSE4.2 and AVX2 versions are compiled for those targets regardless of the build flags, and `best()`
+//! picks the widest one the running CPU supports.
+struct BitmapKernels
+{
+  const char* name;
+  //! Index of the first of the `n` words that differs from `pattern`, or `n` if none does
+  size_t ( *find_word )( const uint64_t* words, size_t n, uint64_t pattern );
+  //! Number of set bits in the `n` words
+  size_t ( *popcount )( const uint64_t* words, size_t n );
+
+  static const BitmapKernels& scalar();
+  //! The kernel sets this CPU can run, scalar first and widest last
+  static const std::vector<const BitmapKernels*>& available();
+  //! The widest supported kernel set (chosen once, on first use)
+  static const BitmapKernels& best();
+};
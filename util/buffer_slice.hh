@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+//! \brief An immutable, reference-counted view of part of a shared string.
+//!
+//! Copying a slice, or cutting a smaller one out of it, only adjusts the shared owner and two offsets. The
+//! bytes are never copied, so a payload can be trimmed and handed from the Reassembler to a ByteStream
+//! without duplicating it. The storage is freed when the last slice referring to it goes away.
+class BufferSlice
+{
+  std::shared_ptr<const std::string> storage_ {};
+  size_t offset_ {};
+  size_t size_ {};
+
+public:
+  BufferSlice() = default;
+
+  //! Take ownership of `data` (moved, not copied)
+  explicit BufferSlice( std::string data )
+    : storage_( std::make_shared<const std::string>( std::move( data ) ) ), size_( storage_->size() )
+  {}
+
+  std::string_view view() const { return { storage_ ? storage_->data() + offset_ : nullptr, size_ }; }
+  const char* data() const { return view().data(); }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  //! Drop the first `n` bytes from the view
+  void remove_prefix( size_t n )
+  {
+    n = std::min( n, size_ );
+    offset_ += n;
+    size_ -= n;
+  }
+
+  //! Keep only the first `n` bytes
+  void truncate( size_t n ) { size_ = std::min( n, size_ ); }
+
+  //! A new slice of up to `len` bytes starting at `pos`, sharing the same storage
+  BufferSlice substr( size_t pos, size_t len = std::string::npos ) const
+  {
+    BufferSlice ret = *this;
+    ret.remove_prefix( pos );
+    ret.truncate( len );
+    return ret;
+  }
+
+  //! Bytes allocated for the whole shared storage (not just this slice's part of it)
+  size_t storage_capacity() const { return storage_ ? storage_->capacity() : 0; }
+};
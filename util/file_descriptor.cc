@@ -3,6 +3,8 @@
 #include "exception.hh"
 
 #include <algorithm>
+#include <array>
+#include <climits>
 #include <fcntl.h>
 #include <iostream>
 #include <stdexcept>
@@ -165,6 +167,76 @@ vector<iovec> 是一个向量，其中的每个元素都是一个 iovec 结构
   }
 }
 
+size_t FileDescriptor::read_into( span<char> buffer )
+{
+  return finish_read_into( ::read( fd_num(), buffer.data(), buffer.size() ), buffer.size(), "read" );
+}
+
+size_t FileDescriptor::read_into( span<const span<char>> buffers )
+{
+  // iovec 放在栈上，入站路径上不做堆分配；超过 IOV_MAX 段 readv 会报 EINVAL，多出的留给下一次读
+  array<iovec, IOV_MAX> iovecs; // NOLINT(*-member-init)
+  const size_t count = min( buffers.size(), iovecs.size() );
+  size_t total_size = 0;
+  for ( size_t i = 0; i < count; ++i ) {
+    iovecs[i] = { buffers[i].data(), buffers[i].size() };
+    total_size += buffers[i].size();
+  }
+
+  return finish_read_into( ::readv( fd_num(), iovecs.data(), static_cast<int>( count ) ), total_size, "readv" );
+}
+
+size_t FileDescriptor::finish_read_into( ssize_t bytes_read, size_t total_size, string_view s_attempt )
+{
+  if ( bytes_read < 0 ) {
+    if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
+      return 0;
+    }
+    throw unix_error { s_attempt };
+  }
+
+  register_read();
+
+  if ( bytes_read == 0 and total_size != 0 ) {
+    internal_fd_->eof_ = true;
+  }
+
+  if ( bytes_read > static_cast<ssize_t>( total_size ) ) {
+    throw runtime_error( "read() read more than requested" );
+  }
+
+  return bytes_read;
+}
+
+size_t FileDescriptor::splice_from( FileDescriptor& source, size_t len )
+{
+  const ssize_t bytes_moved
+    = ::splice( source.fd_num(), nullptr, fd_num(), nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK );
+  if ( bytes_moved < 0 ) {
+    if ( errno == EAGAIN ) {
+      return 0;
+    }
+    throw unix_error { "splice" };
+  }
+
+  source.register_read();
+  register_write();
+
+  if ( bytes_moved == 0 and len != 0 ) {
+    source.set_eof();
+  }
+
+  return bytes_moved;
+}
+
+bool FileDescriptor::can_splice() const
+{
+  struct stat info
+  {};
+  CheckSystemCall( "fstat", fstat( fd_num(), &info ) );
+  return S_ISFIFO( info.st_mode ) or S_ISSOCK( info.st_mode ) or S_ISREG( info.st_mode );
+}
+
 size_t FileDescriptor::write( string_view buffer )
 {
   return write( vector<string_view> { buffer } );
@@ -3,6 +3,9 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <span>
+#include <string_view>
+#include <sys/types.h>
 #include <vector>
 
 // 文件描述符的引用计数句柄
@@ -64,6 +67,9 @@ protected:
   template<typename T>
   T CheckSystemCall( std::string_view s_attempt, T return_value ) const;
 
+  // read_into() 的收尾：处理错误、计数、EOF，返回读取的字节数
+  size_t finish_read_into( ssize_t bytes_read, size_t total_size, std::string_view s_attempt );
+
 public:
   // 根据内核返回的文件描述符编号构造
   explicit FileDescriptor( int fd );
@@ -75,6 +81,16 @@ public:
   void read( std::string& buffer );
   void read( std::vector<std::string>& buffers );
 
+  // 直接读入调用者提供的内存（不分配、不清零），返回读取的字节数；多段时一次 readv 最多用前 IOV_MAX 段
+  size_t read_into( std::span<char> buffer );
+  size_t read_into( std::span<const std::span<char>> buffers );
+
+  // 用 splice(2) 从 `source` 搬运最多 `len` 字节到本描述符，数据不经过用户态（两端至少有一端是 pipe）
+  // 返回搬运的字节数；`source` 到达 EOF 时设置它的 eof 标志
+  size_t splice_from( FileDescriptor& source, size_t len );
+  // 是否能作为 splice 的一端（pipe、socket 或普通文件；终端等字符设备不行）
+  bool can_splice() const;
+
   // 尝试写入缓冲区
   // 返回写入的字节数
   size_t write( std::string_view buffer );
@@ -0,0 +1,88 @@
+#include "mirrored_buffer.hh"
+
+#include "exception.hh"
+
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+bool MirroredBuffer::supported( const size_t size )
+{
+  const auto page_size = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+  return size > 0 and size % page_size == 0;
+}
+
+//! \param[in] size is the length of the ring, which must satisfy `supported()`
+MirroredBuffer::MirroredBuffer( const size_t size ) : size_( size )
+{
+  if ( not supported( size ) ) {
+    throw runtime_error( "MirroredBuffer: size is not a nonzero multiple of the page size" );
+  }
+
+  // the backing memory: an anonymous file that can be mapped more than once
+  const int fd = CheckSystemCall( "memfd_create", memfd_create( "minnow-ring", MFD_CLOEXEC ) );
+  try {
+    CheckSystemCall( "ftruncate", ftruncate( fd, static_cast<off_t>( size ) ) );
+
+    // reserve 2 * size of address space, then map the file over each half
+    void* base = mmap( nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( base == MAP_FAILED ) {
+      throw unix_error { "mmap" };
+    }
+    data_ = static_cast<char*>( base );
+
+    for ( char* half : { data_, data_ + size } ) {
+      if ( mmap( half, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED ) {
+        throw unix_error { "mmap" };
+      }
+    }
+  } catch ( ... ) {
+    unmap();
+    ::close( fd );
+    throw;
+  }
+
+  // the mappings keep the memory alive without the descriptor
+  CheckSystemCall( "close", ::close( fd ) );
+}
+
+void MirroredBuffer::unmap()
+{
+  if ( data_ ) {
+    munmap( data_, 2 * size_ );
+    data_ = nullptr;
+  }
+}
+
+MirroredBuffer::MirroredBuffer( const MirroredBuffer& other ) : size_( other.size_ )
+{
+  if ( other.data_ ) {
+    *this = MirroredBuffer { other.size_ };
+    memcpy( data_, other.data_, size_ );
+  }
+}
+
+MirroredBuffer& MirroredBuffer::operator=( const MirroredBuffer& other )
+{
+  if ( this != &other ) {
+    *this = MirroredBuffer { other };
+  }
+  return *this;
+}
+
+MirroredBuffer::MirroredBuffer( MirroredBuffer&& other ) noexcept
+  : data_( exchange( other.data_, nullptr ) ), size_( exchange( other.size_, 0 ) )
+{}
+
+MirroredBuffer& MirroredBuffer::operator=( MirroredBuffer&& other ) noexcept
+{
+  if ( this != &other ) {
+    unmap();
+    data_ = exchange( other.data_, nullptr );
+    size_ = exchange( other.size_, 0 );
+  }
+  return *this;
+}
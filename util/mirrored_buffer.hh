@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+//! \brief A ring of memory mapped twice, back to back, in virtual memory.
+//!
+//! The same `size()` bytes of physical memory appear at `data()` and again at `data() + size()`, so any
+//! region of up to `size()` bytes that starts inside the first copy is contiguous, even if it wraps
+//! around the end of the ring. `size()` must be a nonzero multiple of the page size (see `supported()`).
+//!
+//! Copies are deep: the new buffer gets its own mapping holding the same bytes.
+class MirroredBuffer
+{
+  char* data_ = nullptr;
+  size_t size_ = 0;
+
+  void unmap();
+
+public:
+  //! An empty buffer that owns no mapping
+  MirroredBuffer() = default;
+  //! Map a new mirrored ring of `size` bytes
+  explicit MirroredBuffer( size_t size );
+  ~MirroredBuffer() { unmap(); }
+
+  MirroredBuffer( const MirroredBuffer& other );
+  MirroredBuffer& operator=( const MirroredBuffer& other );
+  MirroredBuffer( MirroredBuffer&& other ) noexcept;
+  MirroredBuffer& operator=( MirroredBuffer&& other ) noexcept;
+
+  //! Can a ring of `size` bytes be mirrored?
+  static bool supported( size_t size );
+
+  char* data() { return data_; }
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+};
@@ -0,0 +1,130 @@
+#include "page_pool.hh"
+
+#include "exception.hh"
+
+#include <cstring>
+#include <sys/mman.h>
+#include <utility>
+
+using namespace std;
+
+PagePool& PagePool::global()
+{
+  static PagePool pool;
+  return pool;
+}
+
+PagePool::PagePool()
+{
+  free_.reserve( max_cached_ );
+}
+
+//! Pages are mapped one at a time (rather than carved from a larger block) so that each can be unmapped alone.
+char* PagePool::take()
+{
+  {
+    const lock_guard lock { mutex_ };
+    ++in_use_;
+    if ( not free_.empty() ) {
+      char* page = free_.back();
+      free_.pop_back();
+      return page;
+    }
+  }
+
+  void* page = mmap( nullptr, kPageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+  if ( page == MAP_FAILED ) {
+    const lock_guard lock { mutex_ };
+    --in_use_;
+    throw unix_error { "mmap" };
+  }
+  return static_cast<char*>( page );
+}
+
+void PagePool::give( char* page )
+{
+  {
+    const lock_guard lock { mutex_ };
+    --in_use_;
+    if ( free_.size() < max_cached_ ) {
+      free_.push_back( page );
+      return;
+    }
+  }
+  munmap( page, kPageSize );
+}
+
+size_t PagePool::pages_in_use() const
+{
+  const lock_guard lock { mutex_ };
+  return in_use_;
+}
+
+size_t PagePool::pages_cached() const
+{
+  const lock_guard lock { mutex_ };
+  return free_.size();
+}
+
+size_t PagePool::max_cached() const
+{
+  const lock_guard lock { mutex_ };
+  return max_cached_;
+}
+
+void PagePool::set_max_cached( const size_t max_cached )
+{
+  vector<char*> excess;
+  {
+    const lock_guard lock { mutex_ };
+    max_cached_ = max_cached;
+    free_.reserve( max_cached_ );
+    if ( free_.size() > max_cached_ ) {
+      excess.assign( free_.begin() + static_cast<ptrdiff_t>( max_cached_ ), free_.end() );
+      free_.resize( max_cached_ );
+    }
+  }
+  for ( char* page : excess ) {
+    munmap( page, kPageSize );
+  }
+}
+
+PagePool::Page::Page() : data_( global().take() ) {}
+
+PagePool::Page::~Page()
+{
+  if ( data_ ) {
+    global().give( data_ );
+  }
+}
+
+PagePool::Page::Page( const Page& other ) : Page()
+{
+  if ( other.data_ ) {
+    memcpy( data_, other.data_, kPageSize );
+  }
+}
+
+PagePool::Page& PagePool::Page::operator=( const Page& other )
+{
+  if ( this != &other and other.data_ ) {
+    if ( not data_ ) {
+      data_ = global().take();
+    }
+    memcpy( data_, other.data_, kPageSize );
+  }
+  return *this;
+}
+
+PagePool::Page::Page( Page&& other ) noexcept : data_( exchange( other.data_, nullptr ) ) {}
+
+PagePool::Page& PagePool::Page::operator=( Page&& other ) noexcept
+{
+  if ( this != &other ) {
+    if ( data_ ) {
+      global().give( data_ );
+    }
+    data_ = exchange( other.data_, nullptr );
+  }
+  return *this;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+//! \brief A process-wide pool of fixed-size pages for stream buffers.
+//!
+//! Streams take pages when they buffer data and give them back as soon as the data is read, so a stream's
+//! footprint follows the bytes it actually holds. Returned pages are kept for reuse, up to `max_cached()` of
+//! them; beyond that they are unmapped, so the memory of a burst goes back to the OS once the burst drains.
+class PagePool
+{
+public:
+  static constexpr size_t kPageSize = 4096;
+
+  //! \brief An owning handle to one page. Copies are deep (a new page with the same bytes).
+  class Page
+  {
+    char* data_ = nullptr;
+
+  public:
+    Page();
+    ~Page();
+
+    Page( const Page& other );
+    Page& operator=( const Page& other );
+    Page( Page&& other ) noexcept;
+    Page& operator=( Page&& other ) noexcept;
+
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+  };
+
+  static PagePool& global();
+
+  size_t pages_in_use() const;
+  size_t pages_cached() const;
+  size_t max_cached() const;
+  void set_max_cached( size_t max_cached );
+
+private:
+  PagePool();
+
+  char* take();
+  void give( char* page );
+
+  mutable std::mutex mutex_ {};
+  std::vector<char*> free_ {}; // capacity stays >= max_cached_, so give() never allocates
+  size_t in_use_ {};
+  size_t max_cached_ { 1024 };
+};
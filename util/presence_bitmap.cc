@@ -0,0 +1,111 @@
+#include "presence_bitmap.hh"
+
+#include <algorithm>
+#include <bit>
+
+using namespace std;
+
+namespace {
+
+// Bits [begin, end) of one word, with 0 <= begin < end <= 64
+uint64_t word_mask( size_t begin, size_t end )
+{
+  const uint64_t high = end == 64 ? ~uint64_t {} : ( uint64_t { 1 } << end ) - 1;
+  return high & ~( ( uint64_t { 1 } << begin ) - 1 );
+}
+
+} // namespace
+
+void PresenceBitmap::set( size_t begin, size_t end )
+{
+  while ( begin < end ) {
+    const size_t offset = begin % kWordBits;
+    const size_t n = min( end - begin, kWordBits - offset );
+    words_[begin / kWordBits] |= word_mask( offset, offset + n );
+    begin += n;
+  }
+}
+
+void PresenceBitmap::clear( size_t begin, size_t end )
+{
+  while ( begin < end ) {
+    const size_t offset = begin % kWordBits;
+    const size_t n = min( end - begin, kWordBits - offset );
+    words_[begin / kWordBits] &= ~word_mask( offset, offset + n );
+    begin += n;
+  }
+}
+
+size_t PresenceBitmap::find( bool value, size_t begin, size_t end ) const
+{
+  if ( begin >= end ) {
+    return end;
+  }
+  // Invert the words when looking for a zero, so either search becomes "find the lowest set bit"
+  const uint64_t flip = value ? 0 : ~uint64_t {};
+  const auto match = [&]( size_t word, uint64_t mask ) { return ( words_[word] ^ flip ) & mask; };
+
+  // The partial word at the front (which may also be the last one)
+  const size_t first_word = begin / kWordBits;
+  const size_t offset = begin % kWordBits;
+  const size_t head = min( end - begin, kWordBits - offset );
+  if ( const uint64_t hits = match( first_word, word_mask( offset, offset + head ) ) ) {
+    return first_word * kWordBits + static_cast<size_t>( countr_zero( hits ) );
+  }
+  begin += head;
+
+  // Whole words: skip every word with no match in one kernel call
+  const size_t full_end = end / kWordBits;
+  size_t word = begin / kWordBits;
+  if ( word < full_end ) {
+    word += kernels_.get().find_word( words_.data() + word, full_end - word, flip );
+    if ( word < full_end ) {
+      return word * kWordBits + static_cast<size_t>( countr_zero( match( word, ~uint64_t {} ) ) );
+    }
+    begin = full_end * kWordBits;
+  }
+
+  // The partial word at the back
+  if ( begin < end ) {
+    if ( const uint64_t hits = match( word, word_mask( 0, end - begin ) ) ) {
+      return begin + static_cast<size_t>( countr_zero( hits ) );
+    }
+  }
+  return end;
+}
+
+size_t PresenceBitmap::rfind( bool value, size_t begin, size_t end ) const
+{
+  // Walks backward a word at a time; callers start near the match, so no kernel is needed
+  const uint64_t flip = value ? 0 : ~uint64_t {};
+  for ( size_t stop = end; stop > begin; ) {
+    const size_t word = ( stop - 1 ) / kWordBits;
+    const size_t from = max( begin, word * kWordBits );
+    const uint64_t hits = ( words_[word] ^ flip ) & word_mask( from % kWordBits, stop - word * kWordBits );
+    if ( hits ) {
+      return word * kWordBits + kWordBits - 1 - static_cast<size_t>( countl_zero( hits ) );
+    }
+    stop = from;
+  }
+  return end;
+}
+
+size_t PresenceBitmap::count( size_t begin, size_t end ) const
+{
+  if ( begin >= end ) {
+    return 0;
+  }
+  const size_t offset = begin % kWordBits;
+  const size_t head = min( end - begin, kWordBits - offset );
+  size_t total = static_cast<size_t>( popcount( words_[begin / kWordBits] & word_mask( offset, offset + head ) ) );
+  begin += head;
+
+  const size_t full_words = ( end - begin ) / kWordBits;
+  total += kernels_.get().popcount( words_.data() + begin / kWordBits, full_words );
+  begin += full_words * kWordBits;
+
+  if ( begin < end ) {
+    total += static_cast<size_t>( popcount( words_[begin / kWordBits] & word_mask( 0, end - begin ) ) );
+  }
+  return total;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "bitmap_kernels.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+//! \brief A fixed-size bitmap recording which positions of a buffer hold data.
+//!
+//! Range operations work a 64-bit word at a time, so marking or scanning a segment costs one step per 64 bytes
+//! of payload rather than one per byte. Scans over whole words go through BitmapKernels (SIMD when the CPU
+//! supports it).
+class PresenceBitmap
+{
+public:
+  explicit PresenceBitmap( size_t bits = 0, const BitmapKernels& kernels = BitmapKernels::best() )
+    : words_( ( bits + kWordBits - 1 ) / kWordBits ), bits_( bits ), kernels_( kernels )
+  {}
+
+  size_t size() const { return bits_; }
+  bool test( size_t index ) const { return ( words_[index / kWordBits] >> ( index % kWordBits ) ) & 1U; }
+
+  //! Set every bit in [begin, end)
+  void set( size_t begin, size_t end );
+  //! Clear every bit in [begin, end)
+  void clear( size_t begin, size_t end );
+
+  //! The first index in [begin, end) whose bit equals `value`, or `end` if there is none
+  size_t find( bool value, size_t begin, size_t end ) const;
+  //! The last index in [begin, end) whose bit equals `value`, or `end` if there is none
+  size_t rfind( bool value, size_t begin, size_t end ) const;
+  //! Length of the run of set bits starting at `begin` (stopping at `end`)
+  size_t run( size_t begin, size_t end ) const { return find( false, begin, end ) - begin; }
+  //! Number of set bits in [begin, end)
+  size_t count( size_t begin, size_t end ) const;
+
+  const BitmapKernels& kernels() const { return kernels_; }
+
+private:
+  static constexpr size_t kWordBits = 64;
+
+  std::vector<uint64_t> words_;
+  size_t bits_;
+  std::reference_wrapper<const BitmapKernels> kernels_;
+};
@@ -0,0 +1,253 @@
+#include "slab_allocator.hh"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr size_t kNumClasses = bit_width( SlabPool::kMaxBlockSize / SlabPool::kMinBlockSize );
+constexpr size_t kSlabSize = 1 << 20;   // bytes carved at once when the depot runs dry
+constexpr size_t kBatchSize = 32;       // blocks moved between a thread cache and the depot at a time
+constexpr size_t kThreadCacheMax = 128; // blocks a thread cache may hold per class before flushing
+
+size_t size_class( const size_t size )
+{
+  return bit_width( ( max( size, SlabPool::kMinBlockSize ) - 1 ) / SlabPool::kMinBlockSize );
+}
+
+size_t class_size( const size_t cls )
+{
+  return SlabPool::kMinBlockSize << cls;
+}
+
+// Each thread's counters are written only by that thread, so a plain load and store is enough (and avoids a
+// locked instruction per allocation); stats() reads them concurrently through the atomics.
+void bump( atomic<uint64_t>& counter )
+{
+  counter.store( counter.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+}
+
+struct Counters
+{
+  atomic<uint64_t> allocations {};
+  atomic<uint64_t> deallocations {};
+  atomic<uint64_t> thread_cache_hits {};
+  atomic<uint64_t> depot_refills {};
+  atomic<uint64_t> large_allocations {};
+
+  void add_to( SlabPool::Stats& stats, uint64_t& deallocs ) const
+  {
+    stats.allocations += allocations.load( memory_order_relaxed );
+    stats.thread_cache_hits += thread_cache_hits.load( memory_order_relaxed );
+    stats.depot_refills += depot_refills.load( memory_order_relaxed );
+    stats.large_allocations += large_allocations.load( memory_order_relaxed );
+    deallocs += deallocations.load( memory_order_relaxed );
+  }
+
+  void merge_into( Counters& other ) const
+  {
+    other.allocations += allocations.load( memory_order_relaxed );
+    other.deallocations += deallocations.load( memory_order_relaxed );
+    other.thread_cache_hits += thread_cache_hits.load( memory_order_relaxed );
+    other.depot_refills += depot_refills.load( memory_order_relaxed );
+    other.large_allocations += large_allocations.load( memory_order_relaxed );
+  }
+};
+
+struct ThreadCache;
+
+// The shared depot of free blocks, plus the slabs they were carved from.
+struct Depot
+{
+  mutex lock {};
+  array<vector<void*>, kNumClasses> free {};
+  vector<unique_ptr<char[]>> slabs {};
+  vector<const ThreadCache*> caches {};
+  Counters retired {}; // counters from threads that have exited
+
+  // Hand out up to kBatchSize blocks of the given class, carving a new slab if needed.
+  void refill( size_t cls, vector<void*>& out )
+  {
+    const lock_guard guard { lock };
+    auto& list = free.at( cls );
+    if ( list.empty() ) {
+      const size_t block = class_size( cls );
+      const size_t slab_size = max( kSlabSize, block * kBatchSize );
+      slabs.push_back( make_unique_for_overwrite<char[]>( slab_size ) );
+      for ( size_t offset = 0; offset + block <= slab_size; offset += block ) {
+        list.push_back( slabs.back().get() + offset );
+      }
+    }
+    const size_t n = min( kBatchSize, list.size() );
+    out.insert( out.end(), list.end() - static_cast<ptrdiff_t>( n ), list.end() );
+    list.resize( list.size() - n );
+  }
+
+  void give_back( size_t cls, void* const* blocks, size_t n )
+  {
+    const lock_guard guard { lock };
+    free.at( cls ).insert( free.at( cls ).end(), blocks, blocks + n );
+  }
+};
+
+// Leaked on purpose: blocks may still be freed while other static objects are being destroyed.
+Depot& depot()
+{
+  static auto* const instance = new Depot;
+  return *instance;
+}
+
+struct ThreadCache
+{
+  array<vector<void*>, kNumClasses> free {};
+  Counters counters {};
+
+  ThreadCache()
+  {
+    const lock_guard guard { depot().lock };
+    depot().caches.push_back( this );
+  }
+
+  ~ThreadCache()
+  {
+    for ( size_t cls = 0; cls < kNumClasses; ++cls ) {
+      depot().give_back( cls, free.at( cls ).data(), free.at( cls ).size() );
+    }
+    const lock_guard guard { depot().lock };
+    counters.merge_into( depot().retired );
+    erase( depot().caches, this );
+  }
+
+  ThreadCache( const ThreadCache& other ) = delete;
+  ThreadCache& operator=( const ThreadCache& other ) = delete;
+};
+
+// Trivially destructible, so it stays readable while the thread's ThreadCache is being destroyed.
+thread_local bool cache_destroyed = false;
+
+struct ThreadCacheHolder
+{
+  ThreadCache cache {};
+  ThreadCacheHolder() = default;
+  ~ThreadCacheHolder() { cache_destroyed = true; }
+  ThreadCacheHolder( const ThreadCacheHolder& other ) = delete;
+  ThreadCacheHolder& operator=( const ThreadCacheHolder& other ) = delete;
+};
+
+// The calling thread's cache, or null once it has been torn down at thread exit.
+ThreadCache* thread_cache()
+{
+  if ( cache_destroyed ) {
+    return nullptr;
+  }
+  thread_local ThreadCacheHolder holder;
+  return &holder.cache;
+}
+
+// Used on a thread whose cache is already gone (from destructors that run at thread exit).
+void* allocate_without_cache( const size_t size )
+{
+  depot().retired.allocations.fetch_add( 1, memory_order_relaxed );
+  if ( size > SlabPool::kMaxBlockSize ) {
+    depot().retired.large_allocations.fetch_add( 1, memory_order_relaxed );
+    return ::operator new( size );
+  }
+
+  const size_t cls = size_class( size );
+  vector<void*> batch;
+  depot().refill( cls, batch );
+  void* const block = batch.back();
+  batch.pop_back();
+  depot().give_back( cls, batch.data(), batch.size() );
+  return block;
+}
+
+void deallocate_without_cache( void* const ptr, const size_t size )
+{
+  depot().retired.deallocations.fetch_add( 1, memory_order_relaxed );
+  if ( size > SlabPool::kMaxBlockSize ) {
+    ::operator delete( ptr );
+    return;
+  }
+  depot().give_back( size_class( size ), &ptr, 1 );
+}
+
+} // namespace
+
+void* SlabPool::allocate( const size_t size )
+{
+  ThreadCache* const cache = thread_cache();
+  if ( not cache ) {
+    return allocate_without_cache( size );
+  }
+  Counters& counters = cache->counters;
+  bump( counters.allocations );
+
+  if ( size > kMaxBlockSize ) {
+    bump( counters.large_allocations );
+    return ::operator new( size );
+  }
+
+  const size_t cls = size_class( size );
+  auto& list = cache->free[cls];
+  if ( list.empty() ) {
+    bump( counters.depot_refills );
+    depot().refill( cls, list );
+  } else {
+    bump( counters.thread_cache_hits );
+  }
+  void* const block = list.back();
+  list.pop_back();
+  return block;
+}
+
+void SlabPool::deallocate( void* const ptr, const size_t size )
+{
+  if ( not ptr ) {
+    return;
+  }
+
+  ThreadCache* const cache = thread_cache();
+  if ( not cache ) {
+    deallocate_without_cache( ptr, size );
+    return;
+  }
+  Counters& counters = cache->counters;
+  bump( counters.deallocations );
+
+  if ( size > kMaxBlockSize ) {
+    ::operator delete( ptr );
+    return;
+  }
+
+  const size_t cls = size_class( size );
+  auto& list = cache->free[cls];
+  list.push_back( ptr );
+  if ( list.size() > kThreadCacheMax ) {
+    // keep the most recently freed (cache-warm) blocks, return the oldest batch
+    depot().give_back( cls, list.data(), kBatchSize );
+    list.erase( list.begin(), list.begin() + kBatchSize );
+  }
+}
+
+SlabPool::Stats SlabPool::stats()
+{
+  Stats stats;
+  uint64_t deallocations = 0;
+
+  const lock_guard guard { depot().lock };
+  depot().retired.add_to( stats, deallocations );
+  for ( const auto* cache : depot().caches ) {
+    cache->counters.add_to( stats, deallocations );
+  }
+  stats.slabs = depot().slabs.size();
+  stats.outstanding_blocks = stats.allocations - deallocations;
+  return stats;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+//! \brief A process-wide, size-classed slab allocator for stream and segment buffers.
+//!
+//! Requests of up to `kMaxBlockSize` bytes are rounded up to a power-of-two size class (64 bytes and up).
+//! Each thread keeps a small cache of free blocks per class, so most allocations and frees touch no lock.
+//! When a cache runs dry (or overflows), it exchanges a batch of blocks with a shared depot, which carves
+//! new blocks out of large slabs. Slabs are never returned to the system. Larger requests go straight to
+//! `::operator new`.
+class SlabPool
+{
+public:
+  static constexpr size_t kMinBlockSize = 64;
+  static constexpr size_t kMaxBlockSize = 65536;
+
+  struct Stats
+  {
+    uint64_t allocations {};        //!< total calls to allocate()
+    uint64_t thread_cache_hits {};  //!< allocations served from the calling thread's cache
+    uint64_t depot_refills {};      //!< times a thread cache fetched a batch from the depot
+    uint64_t slabs {};              //!< slabs carved since startup
+    uint64_t large_allocations {};  //!< allocations too big for any size class
+    uint64_t outstanding_blocks {}; //!< blocks (of any size) allocated and not yet freed
+
+    double hit_rate() const
+    {
+      return allocations ? static_cast<double>( thread_cache_hits ) / static_cast<double>( allocations ) : 0;
+    }
+  };
+
+  //! Allocate `size` bytes; never returns null
+  static void* allocate( size_t size );
+  //! Free a block from allocate(); `size` must match the size it was allocated with
+  static void deallocate( void* ptr, size_t size );
+
+  //! A snapshot of the counters, summed over all threads
+  static Stats stats();
+};
+
+//! \brief A standard-library allocator that draws from SlabPool
+template<typename T>
+struct SlabAllocator
+{
+  using value_type = T;
+
+  SlabAllocator() = default;
+  template<typename U>
+  explicit SlabAllocator( const SlabAllocator<U>& /* unused */ )
+  {}
+
+  T* allocate( size_t n ) { return static_cast<T*>( SlabPool::allocate( n * sizeof( T ) ) ); }
+  void deallocate( T* ptr, size_t n ) { SlabPool::deallocate( ptr, n * sizeof( T ) ); }
+
+  template<typename U>
+  bool operator==( const SlabAllocator<U>& /* unused */ ) const
+  {
+    return true;
+  }
+};
@@ -15,11 +15,23 @@ public:
   static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
   static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
+  static constexpr uint16_t ACK_DELAY_DFLT = 40;    //!< Default delayed-ACK timeout is 40 milliseconds
+  static constexpr uint8_t MAX_WINDOW_SHIFT = 14;   //!< Largest window scale shift allowed by RFC 7323
+  static constexpr uint16_t RECV_IDLE_DFLT = 1000;  //!< Default idle time before an auto-tuned buffer shrinks
 
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
-  size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
+  size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes (beyond 64 KB needs window scaling)
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
   Wrap32 isn { 137 };                      //!< Default initial sequence number
+
+  bool delayed_ack = true;                    //!< Coalesce ACKs instead of acknowledging every segment
+  uint16_t ack_delay_timeout = ACK_DELAY_DFLT; //!< Longest an ACK for in-order data is held back, in milliseconds
+  unsigned ack_every = 2;                     //!< Acknowledge at least every this many full-sized segments
+
+  bool window_scaling = true; //!< Offer the RFC 7323 window scale option on SYN
+
+  size_t recv_capacity_max = 0;                //!< Ceiling for receive-buffer auto-tuning (0 turns it off)
+  uint16_t recv_idle_timeout = RECV_IDLE_DFLT; //!< Shrink back to recv_capacity after this long idle, in ms
 };
 
 //! Config for classes derived from FdAdapter
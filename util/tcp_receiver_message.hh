@@ -2,26 +2,35 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstdint>
 #include <optional>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains three fields:
+ * It contains four fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
- *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    to receive, starting from the ackno if present, shifted right by window_shift. The maximum value
+ *    is 65,535 (UINT16_MAX from the <cstdint> header).
  *
- * 3) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ * 3) The window shift (RFC 7323). Zero unless both sides offered window scaling on their SYN; the
+ *    actual window is window() = window_size << window_shift. (A window carried on a SYN segment
+ *    itself is never scaled.)
+ *
+ * 4) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
  */
 
 struct TCPReceiverMessage
 {
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
+  uint8_t window_shift {};
   bool RST {};
+
+  // The window in bytes, after undoing the scaling
+  uint64_t window() const { return static_cast<uint64_t>( window_size ) << window_shift; }
 };